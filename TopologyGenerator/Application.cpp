@@ -1,12 +1,19 @@
 #include "Application.h"
+#include "ProceduralShader.h"
 
 // 鏍囧噯搴#include "Application.h"
+#include "ProceduralShader.h"
 
 // 标准库
 #include <iostream>
 #include <vector>
 #include <stdexcept>
 #include <ctime>     
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <cfloat>
+#include <cmath>
 
 // 以下这个define是AI检查的时候推荐的
 // 学到了这是一种防御性编程，虽然在本项目里没有用到std::min/max，但养成习惯总是好的
@@ -20,19 +27,21 @@
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
 
 
 // 构造函数
 Application::Application(unsigned int width, unsigned int height, const char* title)
     : m_window(nullptr), m_width(width), m_height(height), m_title(title),
-    m_shaderProgram(0), m_vao(0), m_vbo(0), m_ebo(0),
+    m_generator(&m_threadPool),
+    m_shaderProgram(0), m_proceduralProgram(0), m_instancedProgram(0), m_vao(0), m_proceduralVao(0),
+    m_symmetryVao(0), m_symmetryVbo(0), m_symmetryEbo(0),
     m_cameraPos(0.0f, 0.0f, 4.0f), m_cameraFront(0.0f, 0.0f, -1.0f), m_cameraUp(0.0f, 1.0f, 0.0f),
     m_yaw(-90.0f), m_pitch(0.0f), m_fov(45.0f),
     m_firstMouse(true), m_lastX(width / 2.0), m_lastY(height / 2.0),
     m_modelRotation(0.0f, 0.0f)
 {
+    // 大多数图形的顶点数都在 65536 以内，默认使用 16 位索引
+    m_params.short_indices = true;
 }
 
 // 这也是AI推荐的，主要用于释放资源，防止内存泄漏
@@ -48,9 +57,17 @@ void Application::run() {
         initImGui();
         initShaders();
         initBuffers();
-
-        m_graph.generate(m_params);
-        updateBuffers();
+        m_profiler.init();
+        m_capture.init(&m_threadPool);
+        // 生成完成时唤醒可能正在等待事件的主循环，glfwPostEmptyEvent 可以在任意线程调用
+        m_generator.setReadyCallback([]() { glfwPostEmptyEvent(); });
+        m_generator.setMeshCache(&m_meshCache);
+        m_speculator.setReadyCallback([]() { glfwPostEmptyEvent(); });
+        // 默认拿出四分之一的硬件线程做预测
+        m_speculator.setThreadCount(std::max(1u, std::thread::hardware_concurrency() / 4));
+
+        // 第一次生成也放到后台，窗口先显示出来
+        m_generator.request(m_params);
 
         mainLoop();
     }
@@ -84,6 +101,14 @@ void Application::initWindow() {
     glfwSetFramebufferSizeCallback(m_window, framebuffer_size_callback);
     glfwSetCursorPosCallback(m_window, mouse_callback);
     glfwSetScrollCallback(m_window, scroll_callback);
+    // 以下事件只用来触发重绘；ImGui 安装自己的回调时会先调用这里设置的回调
+    glfwSetMouseButtonCallback(m_window, mouse_button_callback);
+    glfwSetKeyCallback(m_window, key_callback);
+    glfwSetCharCallback(m_window, char_callback);
+    glfwSetWindowRefreshCallback(m_window, window_refresh_callback);
+
+    // 节能模式下跟随显示器刷新率，避免自动旋转时空转
+    glfwSwapInterval(m_powerSaving ? 1 : 0);
 }
 
 void Application::initGLAD() {
@@ -111,8 +136,10 @@ void Application::initShaders() {
         #version 330 core
         layout (location = 0) in vec3 aPos;
         uniform mat4 mvp;
+        // 16 位归一化坐标解码到 [-1, 1]，再乘以包围盒缩放还原
+        uniform float positionScale;
         void main() {
-            gl_Position = mvp * vec4(aPos, 1.0);
+            gl_Position = mvp * vec4(aPos * positionScale, 1.0);
         }
     )";
     const char* fShaderSrc = R"(
@@ -124,65 +151,246 @@ void Application::initShaders() {
         }
     )";
 
+    m_shaderProgram = createProgram(vShaderSrc, fShaderSrc);
+
+    // GPU 程序化模式的顶点着色器由 gl_VertexID 算出顶点坐标，和离屏渲染器共用（见 ProceduralShader.h）
+    m_proceduralProgram = createProgram(kProceduralVertexShader, fShaderSrc);
+
+    // 实例化模式的顶点着色器：第 i 个实例绕 z 轴旋转 i * 2pi / rotationCount，和 CPU 复制扇区时的旋转相同
+    const char* instancedShaderSrc = R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+        uniform mat4 mvp;
+        uniform int rotationCount;
+
+        const float TWO_PI = 6.28318530718;
+
+        void main() {
+            float angle = float(gl_InstanceID) / float(rotationCount) * TWO_PI;
+            float c = cos(angle);
+            float s = sin(angle);
+            vec3 pos = vec3(aPos.x * c - aPos.y * s, aPos.x * s + aPos.y * c, aPos.z);
+            gl_Position = mvp * vec4(pos, 1.0);
+        }
+    )";
+    m_instancedProgram = createProgram(instancedShaderSrc, fShaderSrc);
+
+    // 对比场景的顶点着色器：每个顶点带所属图形的序号，从纹理缓冲区中取出该图形的 4 列变换矩阵
+    const char* sceneShaderSrc = R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+        layout (location = 1) in uint aItem;
+        uniform mat4 mvp;
+        uniform samplerBuffer transforms;
+
+        void main() {
+            int base = int(aItem) * 4;
+            mat4 transform = mat4(texelFetch(transforms, base), texelFetch(transforms, base + 1),
+                                  texelFetch(transforms, base + 2), texelFetch(transforms, base + 3));
+            gl_Position = mvp * transform * vec4(aPos, 1.0);
+        }
+    )";
+    m_sceneProgram = createProgram(sceneShaderSrc, fShaderSrc);
+}
+
+unsigned int Application::createProgram(const char* vertexSrc, const char* fragmentSrc) {
     unsigned int vShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vShader, 1, &vShaderSrc, NULL);
+    glShaderSource(vShader, 1, &vertexSrc, NULL);
     glCompileShader(vShader);
 
     unsigned int fShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fShader, 1, &fShaderSrc, NULL);
+    glShaderSource(fShader, 1, &fragmentSrc, NULL);
     glCompileShader(fShader);
 
-    m_shaderProgram = glCreateProgram();
-    glAttachShader(m_shaderProgram, vShader);
-    glAttachShader(m_shaderProgram, fShader);
-    glLinkProgram(m_shaderProgram);
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vShader);
+    glAttachShader(program, fShader);
+    glLinkProgram(program);
 
     glDeleteShader(vShader);
     glDeleteShader(fShader);
+
+    // 编译或链接失败时把驱动给出的信息带到异常里
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char info[1024];
+        glGetProgramInfoLog(program, sizeof(info), NULL, info);
+        glDeleteProgram(program);
+        throw std::runtime_error(std::string("Failed to link shader program: ") + info);
+    }
+    return program;
 }
 
 void Application::initBuffers() {
     glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vbo);
-    glGenBuffers(1, &m_ebo);
+    // 程序化模式不读取顶点属性，但核心模式下绘制时必须绑定一个 VAO
+    glGenVertexArrays(1, &m_proceduralVao);
 
+    // 支持 glBufferStorage 时使用持久映射的环形缓冲区，否则使用普通缓冲区
+    BufferStorageProc buffer_storage = StreamBuffer::loadBufferStorage((GLADloadproc)glfwGetProcAddress);
     glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    m_vertexBuffer.init(GL_ARRAY_BUFFER, buffer_storage);
+    m_indexBuffer.init(GL_ELEMENT_ARRAY_BUFFER, buffer_storage);
+    m_vertexBuffer.setThreadPool(&m_threadPool);
+    m_indexBuffer.setThreadPool(&m_threadPool);
+    glEnableVertexAttribArray(0);
+    bindVertexArray();
+    glBindVertexArray(0);
+
+    // 实例化模式只有一个扇区的数据，量很小，直接用普通缓冲区
+    glGenVertexArrays(1, &m_symmetryVao);
+    glGenBuffers(1, &m_symmetryVbo);
+    glGenBuffers(1, &m_symmetryEbo);
+    glBindVertexArray(m_symmetryVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_symmetryVbo);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_symmetryEbo);
+    glBindVertexArray(0);
+
+    // 大规模模式的分块索引，分块完成后整体上传
+    glGenBuffers(1, &m_chunkEbo);
+
+    // 对比场景：坐标和图形序号分别存放，变换矩阵放在纹理缓冲区中
+    glGenVertexArrays(1, &m_sceneVao);
+    glGenBuffers(1, &m_sceneVbo);
+    glGenBuffers(1, &m_sceneItemVbo);
+    glGenBuffers(1, &m_sceneEbo);
+    glBindVertexArray(m_sceneVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_sceneVbo);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
     glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_sceneItemVbo);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_sceneEbo);
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &m_sceneTransformBuffer);
+    glGenTextures(1, &m_sceneTransformTexture);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_sceneTransformBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, m_sceneTransformTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_sceneTransformBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Application::bindVertexArray() {
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.getBuffer());
+    setPositionAttribute(m_graph.getPositionFormat());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer.getBuffer());
+}
+
+void Application::setPositionAttribute(PositionFormat format) {
+    // 顶点属性格式和图形数据的坐标编码一致，紧凑格式每个顶点 8 字节，只读取前 3 个分量
+    GLsizei stride = static_cast<GLsizei>(TopologyGraph::getPositionStride(format));
+    switch (format) {
+    case PositionFormat::SNORM16:
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)0);
+        break;
+    case PositionFormat::HALF_FLOAT:
+        glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, (void*)0);
+        break;
+    default:
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        break;
+    }
 }
 
 // --- 主循环 ---
 void Application::mainLoop() {
     while (!glfwWindowShouldClose(m_window)) {
+        // 没有任何变化时阻塞等待事件，窗口继续显示上一次交换的画面；等待时间不计入帧耗时
+        waitForChanges();
+
+        // 每个阶段单独计时，界面上显示的是之前若干帧的统计
+        m_profiler.beginFrame();
+
 		// 处理所有待处理的窗口事件
+        m_profiler.beginPhase(FramePhase::EVENTS);
         glfwPollEvents();
+        m_profiler.endPhase(FramePhase::EVENTS);
 
 		// 清除颜色缓冲区和深度缓冲区
         glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // 渲染用户界面
+        m_profiler.beginPhase(FramePhase::UI);
         renderUI();
+        m_profiler.endPhase(FramePhase::UI);
+
+        // 换入后台生成的结果，再按变化程度上传
+        // 预测的结果先放进缓存，它换入 m_graph 时要从流式缓冲区复制换出的图形，必须在新结果上传之前
+        m_profiler.beginPhase(FramePhase::GENERATE);
+        fetchSpeculation();
+        GraphChange change = fetchGraph();
+        m_profiler.endPhase(FramePhase::GENERATE);
+        // 界面在换入之前已经构建，再画几帧让点数、边数等信息跟上
+        if (change != GraphChange::NONE) requestRedraw();
+
+        m_profiler.beginPhase(FramePhase::UPLOAD);
+        updateBuffers(change);
+        updateChunks(m_activeRenderMode);
+        updateScene();
+        m_profiler.endPhase(FramePhase::UPLOAD);
 
         // 渲染 3D 场景
+        m_profiler.beginPhase(FramePhase::SCENE);
         renderScene();
+        m_profiler.endPhase(FramePhase::SCENE);
 
         // 将 ImGui 构建的 UI 数据提交给 OpenGL 进行渲染
+        m_profiler.beginPhase(FramePhase::IMGUI_DRAW);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        m_profiler.endPhase(FramePhase::IMGUI_DRAW);
 
-		// 如果需要截图，执行截图操作
+		// 如果需要截图，执行截图操作；截图的编码和分块截图的渲染都在这里推进
+        m_profiler.beginPhase(FramePhase::SCREENSHOT);
         if (m_takeScreenshot) {
             saveFrameToPNG();
             // 重置标志位，防止每帧都截图
             m_takeScreenshot = false; 
         }
+        m_capture.update(m_width, m_height);
+        m_profiler.endPhase(FramePhase::SCREENSHOT);
 
 		// 交换前后缓冲区，显示渲染结果
+        m_profiler.beginPhase(FramePhase::SWAP);
         glfwSwapBuffers(m_window);
+        m_profiler.endPhase(FramePhase::SWAP);
+
+        m_profiler.endFrame();
+        if (m_redrawFrames > 0) --m_redrawFrames;
+    }
+}
+
+bool Application::needsContinuousRedraw() const {
+    // 自动旋转每帧都在变化，分块截图每帧渲染一行块
+    return !m_powerSaving || m_params.autoRotate || m_capture.isTiledCaptureActive();
+}
+
+void Application::waitForChanges() {
+    if (m_redrawFrames > 0 || needsContinuousRedraw()) return;
+
+    // 生成和各后台任务完成时会发出空事件唤醒这里；截图读回要轮询 GPU 的栅栏，只能定时醒来检查
+    const double kPollInterval = 0.05;
+    double timeout = m_capture.getPendingScreenshots() > 0 ? kPollInterval : -1.0;
+    // 按住控件显示预览时，停下 kSettleSeconds 后要醒来开始生成完整图形
+    if (m_requestedPreview && m_inputActive) {
+        double remaining = std::max(0.0, kSettleSeconds - (glfwGetTime() - m_lastEditTime));
+        timeout = timeout < 0.0 ? remaining : std::min(timeout, remaining);
     }
+    if (timeout >= 0.0) glfwWaitEventsTimeout(timeout);
+    else glfwWaitEvents();
+
+    // 醒来之后至少画一帧；由输入事件唤醒时回调已经要求了更多帧
+    m_redrawFrames = std::max(m_redrawFrames, 1);
+    // 等待的时间不算作自动旋转的时间
+    m_lastTime = static_cast<float>(glfwGetTime());
 }
 
 // 渲染用户界面（为什么用英文，因为Imgui对中文的支持很不好）
@@ -192,6 +400,8 @@ void Application::renderUI() {
     ImGui::NewFrame();
 
     bool needs_update = false;
+    // 由各个整数滑动条在拖动时重新设置
+    m_dragField = nullptr;
 
     // 设置窗口大小
     ImGui::SetNextWindowSize(ImVec2(350, 600), ImGuiCond_FirstUseEver);
@@ -202,7 +412,10 @@ void Application::renderUI() {
     ImGui::Text("Right click and drag to rotate objects,\nscroll wheel to zoom in and out.");
     ImGui::Separator();
 
-    const char* items[] = { "2D Topology Map (basic)", "Sphere", "torus"};
+    // 分块截图要跨越多帧，期间图形和渲染路径保持不变，各块才能拼接一致
+    ImGui::BeginDisabled(m_capture.isTiledCaptureActive());
+
+    const char* items[] = { "2D Topology Map (basic)", "Sphere", "torus", "Cube lattice"};
 
 	// 这里用于实现选择不同的结构类型
 	ImGui::Text("Select structure type:");
@@ -222,6 +435,31 @@ void Application::renderUI() {
     if (old_beautify_state != m_params.beautify) {
         needs_update = true;  // 状态改变时触发更新
     }
+    // 合并重合的点、去掉重复边，点数和边数反映真实的图
+    if (ImGui::Checkbox("Weld coincident points", &m_params.weld_vertices)) needs_update = true;
+    // 只影响之后的生成，当前图形不用重新生成
+    bool cache_enabled = m_meshCache.isEnabled();
+    if (ImGui::Checkbox("Disk cache for slow meshes", &cache_enabled)) m_meshCache.setEnabled(cache_enabled);
+
+    // 渲染路径：程序化模式下滑动条只更新 uniform，实例化模式只重新生成一个扇区，两者都不受 CPU 内存限制
+    const char* render_modes[] = { "CPU buffers", "GPU procedural", "Instanced sectors", "Large-scale chunks" };
+    ImGui::Text("Render path:");
+    ImGui::Combo("##10", (int*)&m_renderMode, render_modes, IM_ARRAYSIZE(render_modes));
+    RenderMode active_mode = getActiveRenderMode();
+    if (m_renderMode != active_mode) {
+        ImGui::TextDisabled("Not available for this shape or with welding, using CPU buffers");
+    }
+    // CPU 缓冲区的紧凑编码：16 位坐标和 16 位索引大约能让显存占用和上传量减半
+    if (usesCpuGraph(active_mode)) {
+        const char* position_formats[] = { "float32", "snorm16", "half float" };
+        ImGui::Text("Vertex position format:");
+        if (ImGui::Combo("##11", (int*)&m_params.position_format, position_formats, IM_ARRAYSIZE(position_formats))) needs_update = true;
+        if (ImGui::Checkbox("16-bit indices (up to 65536 points)", &m_params.short_indices)) needs_update = true;
+    }
+
+    // 不经过 CPU 完整生成的渲染路径放宽分辨率上限，大规模模式每帧只绘制可见部分，上限最高
+    int range_scale = active_mode == RenderMode::CHUNKED ? 50 : active_mode == RenderMode::PROCEDURAL ? 20 : 1;
+    int sector_limit = active_mode == RenderMode::INSTANCED ? 10000 : 100 * range_scale;
 
 	// 根据选择的结构类型显示不同的参数选项
     switch (m_params.shape) {
@@ -229,69 +467,525 @@ void Application::renderUI() {
         ImGui::Text("Number of substructures:");
 		//如下的##01等是为了给每个滑动条一个独特的ID，防止冲突
 		//因为ImGui的每个控件都需要一个唯一的标识符
-        if (ImGui::SliderInt("##01", &m_params.topology_sides, 3, 100)) needs_update = true;
+        if (parameterSlider("##01", &Parameters::topology_sides, 3, sector_limit)) needs_update = true;
 		// 如果勾选了美化选项，显示更多参数
         if (m_params.beautify) {
             ImGui::Text("Number of points in each substructure:");
-            if (ImGui::SliderInt("##02", &m_params.topology_points_per_sector, 1, 50)) needs_update = true;
+            if (parameterSlider("##02", &Parameters::topology_points_per_sector, 1, 50)) needs_update = true;
         }
         break;
     case ShapeType::SPHERE:
         ImGui::Text("Number of substructures:");
-		if (ImGui::SliderInt("##03", &m_params.sphere_sectors, 3, 100)) needs_update = true;
+		if (parameterSlider("##03", &Parameters::sphere_sectors, 3, sector_limit)) needs_update = true;
 		// 如果勾选了美化选项，显示更多参数
         if (m_params.beautify) {
             ImGui::Text("Number of points in each substructure:");
-            if (ImGui::SliderInt("##04", &m_params.sphere_points_per_sector, 1, 50)) needs_update = true;
+            if (parameterSlider("##04", &Parameters::sphere_points_per_sector, 1, 50)) needs_update = true;
         }
         ImGui::Text("Height layer:");
-        if (ImGui::SliderInt("##05", &m_params.sphere_layers, 2, 50)) needs_update = true;
+        if (parameterSlider("##05", &Parameters::sphere_layers, 2, 50 * range_scale)) needs_update = true;
         break;
     case ShapeType::TORUS:
         ImGui::Text("Number of main ring segments:");
-        if (ImGui::SliderInt("##06", &m_params.torus_main_segments, 4, 100)) needs_update = true;
+        if (parameterSlider("##06", &Parameters::torus_main_segments, 4, 100 * range_scale)) needs_update = true;
         ImGui::Text("Number of pipe ring segments:");
-        if (ImGui::SliderInt("##07", &m_params.torus_tube_segments, 3, 50)) needs_update = true;
+        if (parameterSlider("##07", &Parameters::torus_tube_segments, 3, 50 * range_scale)) needs_update = true;
         ImGui::Text("Main ring radius:");
         if (ImGui::SliderFloat("##08", &m_params.torus_main_radius, 0.5f, 2.0f)) needs_update = true;
         ImGui::Text("Pipe ring radius:");
         if (ImGui::SliderFloat("##09", &m_params.torus_tube_radius, 0.1f, 1.0f)) needs_update = true;
         break;
+    case ShapeType::CUBE:
+        // 格点数随分段数的三次方增长，大规模模式也只放宽到 200 段
+        ImGui::Text("Segments per edge:");
+        if (parameterSlider("##20", &Parameters::cube_segments, 1, active_mode == RenderMode::CHUNKED ? 200 : 40)) needs_update = true;
+        ImGui::Text("Edge length:");
+        if (ImGui::SliderFloat("##21", &m_params.cube_size, 0.5f, 2.5f)) needs_update = true;
+        break;
+    }
+
+    // 对比场景：主要参数（子结构数、主环段数或棱的分段数）从当前值开始，每个变体增加一个步长
+    if (ImGui::Checkbox("Comparison grid", &m_showScene)) m_sceneDirty = true;
+    if (m_showScene) {
+        ImGui::Text("Variants / step of the main parameter:");
+        if (ImGui::SliderInt("##18", &m_sceneVariants, 2, 1024)) m_sceneDirty = true;
+        if (ImGui::SliderInt("##19", &m_sceneStep, 1, 50)) m_sceneDirty = true;
     }
 
+    ImGui::EndDisabled();
+
     ImGui::Separator();
-    ImGui::Text("Current number of points: %zu", m_graph.getVertexCount());
+    if (m_showScene) {
+        if (m_sceneTask.valid()) {
+            ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Building scene...");
+        }
+        if (m_sceneReady) {
+            ImGui::Text("Scene: %zu graphs (%d x %d), %zu points, %zu edges, 2 draw calls", m_scene.getItems().size(),
+                m_scene.getColumns(), m_scene.getRows(), m_scene.getVertices().size(), m_scene.getIndices().size() / 2);
+        }
+    }
+    // 程序化和实例化模式没有完整的 CPU 数据，点数和边数直接按公式计算
+    MeshSize shown_size = !usesCpuGraph(active_mode) ? TopologyGraph::computeSize(m_params)
+        : MeshSize{ m_graph.getVertexCount(), m_graph.getIndexCount() };
+    ImGui::Text("Current number of points: %zu", shown_size.vertexCount);
 	// 因为边是成对存储的，所以边的数量是索引数量除以2
-    ImGui::Text("Current number of edges: %zu", m_graph.getIndexCount() / 2);
+    ImGui::Text("Current number of edges: %zu", shown_size.indexCount / 2);
+    if (usesCpuGraph(active_mode)) {
+        renderAnalytics();
+    }
+    if (active_mode == RenderMode::CHUNKED) {
+        if (m_chunkTask.valid()) {
+            ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Building chunks...");
+        }
+        else if (m_chunksReady) {
+            ImGui::Text("Visible chunks: %zu / %zu, drawn edges: %zu", m_visibleChunks, m_chunks.getChunks().size(), m_drawnEdges);
+        }
+    }
+    ImGui::Text("Last upload: %.1f KB (%s)", m_lastUploadBytes / 1024.0,
+        m_vertexBuffer.isPersistent() ? "persistent ring" : "sub-data");
+    if (m_generator.isBusy()) {
+        ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Generating...");
+    }
+    if (m_graphIsPreview && usesCpuGraph(active_mode)) {
+        ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Showing coarse preview (%zu points)", m_graph.getVertexCount());
+    }
+    if (m_meshCache.isEnabled()) {
+        MeshCache::Stats cache_stats = m_meshCache.getStats();
+        ImGui::Text("Disk cache: %zu hits, %zu misses, %zu writes", cache_stats.hits, cache_stats.misses, cache_stats.writes);
+        if (m_graph.isFromCache()) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.8f, 1.0f), "(mapped)");
+        }
+        // 生成线程可能正在写入，清空只删除已经完成的文件
+        if (ImGui::Button("Clear disk cache")) m_meshCache.clear();
+    }
+    // 拖动时先显示抽稀的预览，松开或者停下后换成完整图形
+    ImGui::Checkbox("Coarse preview while dragging", &m_progressivePreview);
+    if (m_progressivePreview) {
+        ImGui::SliderInt("Preview points (K)", &m_previewPointsK, 10, 1000);
+    }
+    // 滑动条来回拖动时，回到最近用过的值直接换回缓存的图形，不重新生成和上传
+    int cache_budget_mb = static_cast<int>(m_graphCache.getBudget() >> 20);
+    if (ImGui::SliderInt("Recent graphs (MB)", &cache_budget_mb, 0, 4096)) {
+        m_graphCache.setBudget(static_cast<size_t>(cache_budget_mb) << 20);
+    }
+    const GraphCache::Stats& recent_stats = m_graphCache.getStats();
+    ImGui::Text("Recent graphs: %zu (%.1f MB), %zu hits, %zu misses, %zu evicted", recent_stats.entries,
+        recent_stats.bytes / (1024.0 * 1024.0), recent_stats.hits, recent_stats.misses, recent_stats.evictions);
+    // 拖动整数滑动条时提前生成相邻的值，结果同样放进上面的缓存；线程数为 0 时关闭
+    int prefetch_threads = static_cast<int>(m_speculator.getThreadCount());
+    int max_prefetch_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (ImGui::SliderInt("Prefetch threads", &prefetch_threads, 0, max_prefetch_threads)) {
+        m_speculator.setThreadCount(static_cast<unsigned int>(prefetch_threads));
+        m_speculated.clear();
+    }
+    int prefetch_budget_mb = static_cast<int>(m_speculator.getMaxBytes() >> 20);
+    if (ImGui::SliderInt("Prefetch memory (MB)", &prefetch_budget_mb, 16, 2048)) {
+        m_speculator.setMaxBytes(static_cast<size_t>(prefetch_budget_mb) << 20);
+        m_speculated.clear();
+    }
+    SpeculativeGenerator::Stats prefetch_stats = m_speculator.getStats();
+    ImGui::Text("Prefetch: %zu started, %zu done, %zu cancelled, %zu over budget", prefetch_stats.started,
+        prefetch_stats.completed, prefetch_stats.cancelled, prefetch_stats.skipped);
     
 	// 添加截图按钮
     ImGui::Spacing();
     if (ImGui::Button("save as PNG image")) {
 		m_takeScreenshot = true;// 设置截图标志
     }
+    if (m_capture.getPendingScreenshots() > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Saving %d...", m_capture.getPendingScreenshots());
+    }
+
+    // 分块截图：按指定尺寸离屏渲染，不包含界面
+    ImGui::Text("High-res capture (width x height):");
+    ImGui::InputInt("##16", &m_tiledWidth, 1024);
+    ImGui::InputInt("##17", &m_tiledHeight, 1024);
+    m_tiledWidth = std::min(std::max(m_tiledWidth, 1), kMaxTiledSize);
+    m_tiledHeight = std::min(std::max(m_tiledHeight, 1), kMaxTiledSize);
+    if (m_capture.isTiledCaptureActive()) {
+        ImGui::ProgressBar(m_capture.getTiledProgress(), ImVec2(-1.0f, 0.0f));
+    }
+    else if (ImGui::Button("capture tiled PNG")) {
+        startTiledCapture();
+    }
+
+    // 网格导出，只有 CPU 缓冲区模式下 m_graph 才是完整的当前图形
+    if (m_exportTask.valid() && m_exportTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        m_exportStatus = (m_exportTask.get() ? "Exported to " : "Failed to export ") + m_exportPath;
+    }
+    if (usesCpuGraph(active_mode)) {
+        const char* format_names[] = { "OBJ", "PLY (binary)", "glTF (.gltf + .bin)" };
+        int format_index = static_cast<int>(m_exportFormat);
+        if (ImGui::Combo("##12", &format_index, format_names, IM_ARRAYSIZE(format_names))) {
+            m_exportFormat = static_cast<MeshExporter::Format>(format_index);
+        }
+        if (m_exportTask.valid()) {
+            ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Exporting...");
+        }
+        else if (ImGui::Button("export mesh")) {
+            exportMesh();
+        }
+    }
+    else {
+        ImGui::TextDisabled("Mesh export uses the CPU buffers render path");
+    }
+    if (!m_exportStatus.empty()) {
+        ImGui::TextWrapped("%s", m_exportStatus.c_str());
+    }
+
+    ImGui::Separator();
+    // 关闭后每帧都重绘并且不等待垂直同步，用于测量最高帧率
+    if (ImGui::Checkbox("Power saving (redraw on changes only)", &m_powerSaving)) {
+        glfwSwapInterval(m_powerSaving ? 1 : 0);
+    }
+    renderProfiler();
 
     ImGui::End();
 
 	// 渲染 ImGui 界面
     ImGui::Render();
 
-	// 如果参数有变化，重新生成图形并更新缓冲区
+	// 如果参数或渲染路径有变化，按当前渲染路径更新数据：
+    // CPU 缓冲区交给后台线程重新生成，不阻塞当前帧；实例化模式只重新生成一个扇区；程序化模式只需要下一帧更新 uniform
+    active_mode = getActiveRenderMode();
+    bool mode_changed = active_mode != m_activeRenderMode;
+    m_activeRenderMode = active_mode;
+    m_inputActive = ImGui::IsAnyItemActive();
     if (needs_update) {
-        m_graph.generate(m_params);
-        updateBuffers();
+        m_sceneDirty = true;
+        m_lastEditTime = glfwGetTime();
+    }
+    if (needs_update || mode_changed) {
+        if (usesCpuGraph(active_mode)) {
+            requestGraph(true);
+        }
+        else if (active_mode == RenderMode::INSTANCED) {
+            updateSymmetryBuffers();
+        }
+    }
+    // 预览之后补上完整图形：松开控件，或者按住不动超过 kSettleSeconds
+    else if (m_requestedPreview && usesCpuGraph(active_mode) &&
+        (!m_inputActive || glfwGetTime() - m_lastEditTime >= kSettleSeconds)) {
+        requestGraph(false);
     }
+    // 其他渲染路径不使用 m_graph，也就不需要细化
+    if (!usesCpuGraph(active_mode)) m_requestedPreview = false;
+    updateSpeculation(active_mode);
 }
 
-void Application::renderScene() {
-    glUseProgram(m_shaderProgram);
+bool Application::parameterSlider(const char* label, int Parameters::* field, int min, int max) {
+    int before = m_params.*field;
+    bool changed = ImGui::SliderInt(label, &(m_params.*field), min, max);
+    if (ImGui::IsItemActive()) {
+        m_dragField = field;
+        m_dragMin = min;
+        m_dragMax = max;
+        if (m_params.*field != before) m_dragDirection = m_params.*field > before ? 1 : -1;
+    }
+    return changed;
+}
+
+void Application::updateSpeculation(RenderMode activeMode) {
+    if (!m_dragField) m_dragDirection = 0;
+
+    std::vector<Parameters> candidates;
+    // 结果要放进 m_graphCache 才能用上，缓存关闭或者不使用 CPU 图形时不预测
+    if (m_dragField && usesCpuGraph(activeMode) && m_graphCache.getBudget() > 0 && m_speculator.getThreadCount() > 0) {
+        // 沿拖动方向的两个值优先，还没有方向时两侧交替
+        int d = m_dragDirection < 0 ? -1 : 1;
+        int offsets[4] = { d, -d, 2 * d, -2 * d };
+        if (m_dragDirection != 0) {
+            offsets[1] = 2 * d;
+            offsets[2] = -d;
+        }
+        int value = m_params.*m_dragField;
+        for (int offset : offsets) {
+            int neighbor = value + offset;
+            if (neighbor < m_dragMin || neighbor > m_dragMax) continue;
+            Parameters params = m_params;
+            params.*m_dragField = neighbor;
+            // 已经缓存的值和当前显示的图形不用再生成
+            if (m_graphCache.contains(params)) continue;
+            if (m_graph.hasGenerated() && TopologyGraph::classifyChange(m_graph.getParameters(), params) == GraphChange::NONE) continue;
+            candidates.push_back(params);
+        }
+    }
+
+    // 候选不变时不打扰后台线程，松开滑动条后取消剩余的预测
+    bool unchanged = candidates.size() == m_speculated.size() &&
+        std::equal(candidates.begin(), candidates.end(), m_speculated.begin(), [](const Parameters& a, const Parameters& b) {
+            return TopologyGraph::classifyChange(a, b) == GraphChange::NONE;
+        });
+    if (unchanged) return;
+    m_speculated = candidates;
+    if (candidates.empty()) m_speculator.cancel();
+    else m_speculator.speculate(candidates);
+}
+
+void Application::fetchSpeculation() {
+    TopologyGraph graph;
+    while (m_speculator.fetch(graph)) {
+        const Parameters& params = graph.getParameters();
+        // 等待期间缓存可能已经有了这个值，或者主生成器已经把它换入
+        if (!m_graphCache.accepts(graph) || m_graphCache.contains(params)) continue;
+        if (m_graph.hasGenerated() && TopologyGraph::classifyChange(m_graph.getParameters(), params) == GraphChange::NONE) continue;
+        bool wanted = TopologyGraph::classifyChange(m_params, params) == GraphChange::NONE;
+        m_graphCache.insert(graph, createResidentMesh(graph, false));
+        requestRedraw();
+        // 滑动条已经到了这个值、主生成器还在生成时，直接换入预测的结果
+        if (wanted && usesCpuGraph(m_activeRenderMode) && !isGraphBusy() && !m_capture.isTiledCaptureActive()) requestGraph(true);
+    }
+}
+
+void Application::requestGraph(bool allowPreview) {
+    // 当前图形就是要的结果（例如滑动条拖回原处），只需丢弃还在排队或生成中的请求
+    if (m_graph.hasGenerated() && !m_graphIsPreview &&
+        TopologyGraph::classifyChange(m_graph.getParameters(), m_params) == GraphChange::NONE) {
+        m_generator.cancel();
+        m_requestedPreview = false;
+        return;
+    }
+
+    // 和 fetchGraph 一样，有后台任务读取 m_graph 时不能换掉它，交给生成器，等任务结束后再换入
+    if (m_graphCache.getBudget() > 0 && !isGraphBusy() && !m_capture.isTiledCaptureActive()) {
+        TopologyGraph cached;
+        ResidentMesh mesh;
+        if (m_graphCache.take(m_params, cached, mesh)) {
+            // 之前的请求已经过时，它的结果不能再换入
+            m_generator.cancel();
+            retainGraph();
+            std::swap(m_graph, cached);
+            m_residentMesh = mesh;
+            m_drawResident = true;
+            m_graphIsPreview = false;
+            m_requestedPreview = false;
+            m_lastUploadBytes = 0;
+            onGraphReplaced(GraphChange::TOPOLOGY);
+            requestRedraw();
+            return;
+        }
+    }
+
+    // 按住控件修改大图形时先生成抽稀的预览，拖动时的延迟只取决于预览的大小
+    Parameters target = m_params;
+    bool preview = false;
+    if (allowPreview && m_progressivePreview && m_inputActive) {
+        target = TopologyGraph::makePreviewParameters(m_params, static_cast<size_t>(m_previewPointsK) * 1000);
+        preview = TopologyGraph::classifyChange(target, m_params) != GraphChange::NONE;
+    }
+    m_requestedPreview = preview;
+    // 抽稀后参数没变（滑动条只移动了一小格），当前的预览可以继续用
+    if (preview && m_graph.hasGenerated() && TopologyGraph::classifyChange(m_graph.getParameters(), target) == GraphChange::NONE) {
+        m_generator.cancel();
+        return;
+    }
+    m_generator.request(target);
+}
+
+void Application::retainGraph() {
+    // 预览很快就能重新生成，不占用缓存
+    if (!m_graph.hasGenerated() || m_graphIsPreview || !m_graphCache.accepts(m_graph)) {
+        // 放不进缓存的图形留在 m_graph 中，稍后和生成器交换后作为下一次生成的工作区
+        if (m_drawResident) GraphCache::releaseMesh(m_residentMesh);
+        m_drawResident = false;
+        return;
+    }
+    ResidentMesh mesh = m_drawResident ? m_residentMesh : createResidentMesh(m_graph, true);
+    m_residentMesh = ResidentMesh();
+    m_drawResident = false;
+    m_graphCache.insert(m_graph, mesh);
+}
+
+ResidentMesh Application::createResidentMesh(const TopologyGraph& graph, bool fromStreamBuffers) {
+    size_t vertex_bytes = graph.getVertexCount() * TopologyGraph::getPositionStride(graph.getPositionFormat());
+    size_t index_bytes = graph.getIndexCount() * (graph.hasShortIndices() ? sizeof(uint16_t) : sizeof(unsigned int));
+
+    ResidentMesh mesh;
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vertexBuffer);
+    glGenBuffers(1, &mesh.indexBuffer);
+
+    // 不经过 VAO 的绑定点写入
+    if (fromStreamBuffers) {
+        // 流式缓冲区中当前段的数据就是 m_graph 上传的数据
+        glBindBuffer(GL_COPY_READ_BUFFER, m_vertexBuffer.getBuffer());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.vertexBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertex_bytes, nullptr, GL_STATIC_DRAW);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, m_vertexBuffer.getOffset(), 0, vertex_bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, m_indexBuffer.getBuffer());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.indexBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, index_bytes, nullptr, GL_STATIC_DRAW);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, m_indexBuffer.getOffset(), 0, index_bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        // 复制命令也在读当前段，GPU 执行完之前环形缓冲区不能覆盖它
+        m_vertexBuffer.markInUse();
+        m_indexBuffer.markInUse();
+    }
+    else {
+        // 和 updateBuffers 一样，有紧凑编码时只上传紧凑数据
+        const void* vertex_data = graph.getPositionFormat() == PositionFormat::FLOAT32 ?
+            static_cast<const void*>(graph.getVertices().data()) : static_cast<const void*>(graph.getPackedPositions().data());
+        const void* index_data = graph.hasShortIndices() ?
+            static_cast<const void*>(graph.getShortIndices().data()) : static_cast<const void*>(graph.getIndices().data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.vertexBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertex_bytes, vertex_data, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.indexBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, index_bytes, index_data, GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+    setPositionAttribute(graph.getPositionFormat());
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return mesh;
+}
+
+void Application::onGraphReplaced(GraphChange change) {
+    m_metricsDirty = true;
+    if (change != GraphChange::NONE) {
+        m_chunksDirty = true;
+        m_chunksReady = false;
+    }
+}
+
+GraphChange Application::fetchGraph() {
+    // 后台生成完成后换入新数据，正在导出、分析或分块时先不换入，结果留在生成器里等它们结束
+    GraphChange change = GraphChange::NONE;
+    bool can_fetch = !isGraphBusy() && !m_capture.isTiledCaptureActive();
+    // 拓扑参数变化时，换入之前把当前图形留在缓存里，之后拖回这个值时不用重新生成
+    // 只改几何参数时当前图形交还生成器，下一次拖动半径或棱长仍然只更新坐标
+    bool was_resident = m_drawResident;
+    bool fetched = can_fetch && m_generator.fetch(m_graph, change, [this](TopologyGraph&) { retainGraph(); });
+    if (fetched) {
+        // 之前绘制的是缓存的缓冲区，流式缓冲区中不是换出的图形，变化程度不可信，整体比较后上传
+        if (was_resident) {
+            change = GraphChange::TOPOLOGY;
+            // 没有放回缓存时它的 GPU 数据也不再需要
+            if (m_drawResident) GraphCache::releaseMesh(m_residentMesh);
+            m_drawResident = false;
+        }
+        // 生成器只交出最近一次请求的结果
+        m_graphIsPreview = m_requestedPreview;
+        onGraphReplaced(change);
+    }
+
+    // 分析直接读取 m_graph，不复制数据
+    if (m_showAnalytics && m_metricsDirty && !m_analyticsTask.valid() &&
+        usesCpuGraph(m_activeRenderMode) && m_graph.hasGenerated()) {
+        m_metricsDirty = false;
+        unsigned int source = static_cast<unsigned int>(m_bfsSource);
+        m_analyticsTask = std::async(std::launch::async, [this, source]() {
+            GraphMetrics metrics = GraphAnalytics::analyze(m_graph, source, &m_threadPool);
+            // 唤醒主循环显示结果
+            glfwPostEmptyEvent();
+            return metrics;
+        });
+    }
+    return fetched ? change : GraphChange::NONE;
+}
+
+void Application::updateChunks(RenderMode activeMode) {
+    if (m_chunkTask.valid() && m_chunkTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        m_chunkTask.get();
+        std::swap(m_chunks, m_pendingChunks);
+        m_pendingChunks.clear();
+        // 不经过 VAO 的绑定点上传，避免改动当前 VAO 记录的索引缓冲区
+        const std::vector<unsigned int>& indices = m_chunks.getIndices();
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_chunkEbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_chunksReady = true;
+        requestRedraw();
+    }
+
+    // 分块只在大规模模式下进行，切换到其他模式时保留已有结果
+    if (activeMode == RenderMode::CHUNKED && m_chunksDirty && !m_chunkTask.valid() && m_graph.hasGenerated()) {
+        m_chunksDirty = false;
+        m_chunkTask = std::async(std::launch::async, [this]() {
+            m_pendingChunks.build(m_graph, &m_threadPool);
+            glfwPostEmptyEvent();
+        });
+    }
+}
+
+void Application::renderAnalytics() {
+    if (m_analyticsTask.valid() && m_analyticsTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        m_metrics = m_analyticsTask.get();
+        m_hasMetrics = true;
+    }
+
+    if (ImGui::Checkbox("Graph analytics", &m_showAnalytics)) m_metricsDirty = true;
+    if (!m_showAnalytics) return;
+
+    ImGui::Text("BFS source point:");
+    if (ImGui::InputInt("##13", &m_bfsSource)) {
+        int last = std::max(0, static_cast<int>(m_graph.getVertexCount()) - 1);
+        m_bfsSource = std::min(std::max(m_bfsSource, 0), last);
+        m_metricsDirty = true;
+    }
+
+    if (m_analyticsTask.valid()) {
+        ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Analyzing...");
+    }
+    if (!m_hasMetrics) return;
+
+    ImGui::Text("Degree min / avg / max: %zu / %.2f / %zu", m_metrics.minDegree, m_metrics.averageDegree, m_metrics.maxDegree);
+    // 直方图只有几十项，每帧转换一次即可
+    std::vector<float> histogram(m_metrics.degreeHistogram.begin(), m_metrics.degreeHistogram.end());
+    ImGui::PlotHistogram("##14", histogram.data(), static_cast<int>(histogram.size()), 0, "Degree histogram", 0.0f, FLT_MAX, ImVec2(0, 60));
+    ImGui::Text("Connected components: %zu (largest %zu points)", m_metrics.componentCount, m_metrics.largestComponentSize);
+    ImGui::Text("BFS from point %u: eccentricity %u, reached %zu", m_metrics.bfsSource, m_metrics.eccentricity, m_metrics.reachedCount);
+    ImGui::Text("Approximate diameter: >= %u", m_metrics.approximateDiameter);
+}
+
+void Application::renderProfiler() {
+    ImGui::Checkbox("Frame profiler", &m_showProfiler);
+    if (!m_showProfiler) return;
+
+    // 最近若干帧的总耗时曲线，卡顿会显示成尖峰
+    std::vector<float> frame_times = m_profiler.getFrameTimes();
+    if (!frame_times.empty()) {
+        ImGui::PlotLines("##15", frame_times.data(), static_cast<int>(frame_times.size()), 0, "Frame time (ms)", 0.0f, FLT_MAX, ImVec2(0, 60));
+    }
+
+    ImGui::Text("%-11s %15s %15s", "phase (ms)", "CPU p50 / p99", "GPU p50 / p99");
+    for (int i = 0; i < FrameProfiler::kPhaseCount; ++i) {
+        FramePhase phase = static_cast<FramePhase>(i);
+        ImGui::Text("%-11s %6.2f / %6.2f %6.2f / %6.2f", FrameProfiler::getPhaseName(phase),
+            m_profiler.getCpuPercentile(phase, 0.5), m_profiler.getCpuPercentile(phase, 0.99),
+            m_profiler.getGpuPercentile(phase, 0.5), m_profiler.getGpuPercentile(phase, 0.99));
+    }
+
+    // 导出最近若干帧的逐阶段数据
+    if (ImGui::Button("dump CSV")) {
+        std::string path = makeTimestampedPath("profiles", ".csv");
+        if (!path.empty()) {
+            m_profileStatus = (m_profiler.writeCsv(path) ? "Saved " : "Failed to save ") + path;
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("dump Chrome trace")) {
+        std::string path = makeTimestampedPath("profiles", ".json");
+        if (!path.empty()) {
+            m_profileStatus = (m_profiler.writeChromeTrace(path) ? "Saved " : "Failed to save ") + path;
+        }
+    }
+    if (!m_profileStatus.empty()) {
+        ImGui::TextWrapped("%s", m_profileStatus.c_str());
+    }
+}
 
+void Application::renderScene() {
     // 视图和投影矩阵
     glm::mat4 view = glm::lookAt(m_cameraPos, m_cameraPos + m_cameraFront, m_cameraUp);
     glm::mat4 proj = glm::perspective(glm::radians(m_fov), (float)m_width / m_height, 0.1f, 100.0f);
 
-    // 模型矩阵现在根据鼠标输入动态计算
-    glm::mat4 model = glm::mat4(1.0f);
-
     float currentTime = glfwGetTime();
     float deltaTime = currentTime - m_lastTime;
     m_lastTime = currentTime;
@@ -303,96 +997,469 @@ void Application::renderScene() {
         if (m_autoRotationAngle >= 360.0f) {
             m_autoRotationAngle -= 360.0f;
         }
+    }
+
+    drawScene(view, proj, getModelMatrix(), static_cast<float>(m_height));
+}
+
+glm::mat4 Application::getModelMatrix() const {
+    // 模型矩阵现在根据鼠标输入动态计算
+    glm::mat4 model = glm::mat4(1.0f);
+    if (m_params.autoRotate) {
         model = glm::rotate(model, glm::radians(m_autoRotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
     }
 
     // 手动旋转
     model = glm::rotate(model, glm::radians(m_modelRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
     model = glm::rotate(model, glm::radians(m_modelRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+    return model;
+}
+
+void Application::drawScene(const glm::mat4& view, const glm::mat4& proj, const glm::mat4& model, float viewportHeight) {
+    glUseProgram(m_shaderProgram);
 
     // 计算最终的 MVP 矩阵
     glm::mat4 mvp = proj * view * model;
+
+    // 对比场景替代单个图形，生成完成前仍绘制单个图形
+    if (m_showScene && m_sceneReady) {
+        renderGraphScene(mvp);
+        return;
+    }
+
+    // GPU 程序化模式不使用顶点和索引缓冲区，实例化模式只使用一个扇区的数据
+    if (m_activeRenderMode == RenderMode::PROCEDURAL) {
+        renderProcedural(mvp);
+        return;
+    }
+    if (m_activeRenderMode == RenderMode::INSTANCED) {
+        renderInstanced(mvp);
+        return;
+    }
+
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(mvp));
+    glUniform1f(glGetUniformLocation(m_shaderProgram, "positionScale"), m_graph.getPositionScale());
 
-    glBindVertexArray(m_vao);
+    // 缓存换回的图形用自己的缓冲区，数据从开头开始；环形缓冲区模式下当前数据不一定从缓冲区开头开始，换算成起始顶点和索引偏移
+    glBindVertexArray(m_drawResident ? m_residentMesh.vao : m_vao);
+    GLint base_vertex = m_drawResident ? 0 :
+        static_cast<GLint>(m_vertexBuffer.getOffset() / TopologyGraph::getPositionStride(m_graph.getPositionFormat()));
+    const void* index_offset = m_drawResident ? nullptr : reinterpret_cast<const void*>(m_indexBuffer.getOffset());
+    GLenum index_type = m_graph.hasShortIndices() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    if (m_activeRenderMode == RenderMode::CHUNKED && m_chunksReady) {
+        renderChunked(mvp, view * model, base_vertex, viewportHeight);
+    }
+    else {
+        // 绘制边
+        glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 0.7f, 0.7f, 0.7f);
+        glDrawElementsBaseVertex(GL_LINES, static_cast<GLsizei>(m_graph.getIndexCount()), index_type, index_offset, base_vertex);
+
+        // 绘制节点
+        glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 0.2f, 0.8f, 0.8f);
+        glPointSize(5.0f);
+        glDrawArrays(GL_POINTS, base_vertex, static_cast<GLsizei>(m_graph.getVertexCount()));
+    }
+
+    glBindVertexArray(0);
+
+    // GPU 读完这一帧用到的数据之前，缓冲区不会覆盖它们
+    m_vertexBuffer.markInUse();
+    m_indexBuffer.markInUse();
+}
+
+void Application::renderChunked(const glm::mat4& mvp, const glm::mat4& modelView, GLint baseVertex, float viewportHeight) {
+    // 从 MVP 矩阵的行向量组合出模型空间中的 6 个裁剪平面（Gribb-Hartmann），法线指向视锥内侧
+    glm::mat4 rows = glm::transpose(mvp);
+    glm::vec4 planes[6] = {
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2]
+    };
+    // 模型空间中的相机位置，以及距离为 1 处一个单位长度对应的像素数
+    glm::vec3 eye = glm::vec3(glm::inverse(modelView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    float pixels_per_unit = viewportHeight / (2.0f * std::tan(glm::radians(m_fov) * 0.5f));
+    // 聚类格子在屏幕上不超过这么多像素时使用该级 LOD
+    const float kLodPixelSize = 3.0f;
+
+    m_drawCounts.clear();
+    m_drawOffsets.clear();
+    m_visibleChunks = 0;
+    m_drawnEdges = 0;
+    std::vector<int> levels;
+    levels.reserve(m_chunks.getChunks().size());
+    for (const MeshChunk& chunk : m_chunks.getChunks()) {
+        // 包围盒在法线方向上最靠前的角点也在某个平面外侧时，整块都不可见
+        bool visible = true;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 corner(plane.x >= 0.0f ? chunk.boundsMax.x : chunk.boundsMin.x,
+                             plane.y >= 0.0f ? chunk.boundsMax.y : chunk.boundsMin.y,
+                             plane.z >= 0.0f ? chunk.boundsMax.z : chunk.boundsMin.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+                visible = false;
+                break;
+            }
+        }
+        if (!visible) {
+            levels.push_back(-1);
+            continue;
+        }
 
-    // 绘制边
+        // 用相机到包围盒的最近距离估算投影大小，相机在包围盒内时按近平面距离计算
+        glm::vec3 closest = glm::clamp(eye, chunk.boundsMin, chunk.boundsMax);
+        float distance = std::max(glm::length(eye - closest), 0.1f);
+        int level = 0;
+        while (level + 1 < m_chunks.getLodCount() &&
+               m_chunks.getLodCellSize(level + 1) * pixels_per_unit / distance <= kLodPixelSize) {
+            ++level;
+        }
+        levels.push_back(level);
+        if (chunk.edgeCounts[level] == 0) continue;
+        m_drawCounts.push_back(static_cast<GLsizei>(chunk.edgeCounts[level]));
+        m_drawOffsets.push_back(reinterpret_cast<const void*>(chunk.edgeOffsets[level] * sizeof(unsigned int)));
+        m_drawnEdges += chunk.edgeCounts[level] / 2;
+        ++m_visibleChunks;
+    }
+    m_drawBaseVertices.assign(m_drawCounts.size(), baseVertex);
+
+    // 分块索引临时替换 VAO 中的索引缓冲区，所有可见块一次绘制
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_chunkEbo);
     glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 0.7f, 0.7f, 0.7f);
-    glDrawElements(GL_LINES, static_cast<GLsizei>(m_graph.getIndexCount()), GL_UNSIGNED_INT, 0);
+    glMultiDrawElementsBaseVertex(GL_LINES, m_drawCounts.data(), GL_UNSIGNED_INT, m_drawOffsets.data(),
+        static_cast<GLsizei>(m_drawCounts.size()), m_drawBaseVertices.data());
+
+    m_drawCounts.clear();
+    m_drawOffsets.clear();
+    const std::vector<MeshChunk>& chunks = m_chunks.getChunks();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (levels[i] < 0 || chunks[i].pointCounts[levels[i]] == 0) continue;
+        m_drawCounts.push_back(static_cast<GLsizei>(chunks[i].pointCounts[levels[i]]));
+        m_drawOffsets.push_back(reinterpret_cast<const void*>(chunks[i].pointOffsets[levels[i]] * sizeof(unsigned int)));
+    }
+    m_drawBaseVertices.assign(m_drawCounts.size(), baseVertex);
+    glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 0.2f, 0.8f, 0.8f);
+    glPointSize(5.0f);
+    glMultiDrawElementsBaseVertex(GL_POINTS, m_drawCounts.data(), GL_UNSIGNED_INT, m_drawOffsets.data(),
+        static_cast<GLsizei>(m_drawCounts.size()), m_drawBaseVertices.data());
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_drawResident ? m_residentMesh.indexBuffer : m_indexBuffer.getBuffer());
+}
+
+RenderMode Application::getActiveRenderMode() const {
+    // 焊接只在 CPU 生成的完整数据上进行，大规模模式本身就使用 CPU 数据
+    if (m_params.weld_vertices) return m_renderMode == RenderMode::CHUNKED ? RenderMode::CHUNKED : RenderMode::BUFFERS;
+    switch (m_renderMode) {
+    case RenderMode::PROCEDURAL:
+        // 美化结构没有在着色器中实现，开启美化时仍然走 CPU 生成
+        if (supportsProceduralShape(m_params)) {
+            return RenderMode::PROCEDURAL;
+        }
+        break;
+    case RenderMode::INSTANCED:
+        // 圆环的美化结构每隔 2、3 个主段才重复一次，不是按主段旋转对称的
+        if (m_params.shape == ShapeType::TOPOLOGY_2D || m_params.shape == ShapeType::SPHERE) {
+            return RenderMode::INSTANCED;
+        }
+        break;
+    case RenderMode::CHUNKED:
+        return RenderMode::CHUNKED;
+    default:
+        break;
+    }
+    return RenderMode::BUFFERS;
+}
+
+std::vector<SceneItem> Application::makeSceneItems() const {
+    std::vector<SceneItem> items(m_sceneVariants);
+    for (int i = 0; i < m_sceneVariants; ++i) {
+        Parameters params = m_params;
+        // 场景直接使用 32 位浮点坐标和 32 位索引
+        params.position_format = PositionFormat::FLOAT32;
+        params.short_indices = false;
+        int offset = i * m_sceneStep;
+        switch (params.shape) {
+        case ShapeType::TOPOLOGY_2D:
+            params.topology_sides += offset;
+            break;
+        case ShapeType::SPHERE:
+            params.sphere_sectors += offset;
+            break;
+        case ShapeType::TORUS:
+            params.torus_main_segments += offset;
+            break;
+        case ShapeType::CUBE:
+            params.cube_segments += offset;
+            break;
+        default:
+            break;
+        }
+        items[i].params = params;
+    }
+    return items;
+}
+
+void Application::updateScene() {
+    // 分块截图期间不换入，保证各块画的是同一个场景
+    if (m_sceneTask.valid() && !m_capture.isTiledCaptureActive() &&
+        m_sceneTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        m_sceneTask.get();
+        std::swap(m_scene, m_pendingScene);
+        m_pendingScene.clear();
+
+        const std::vector<glm::vec3>& vertices = m_scene.getVertices();
+        const std::vector<unsigned int>& item_ids = m_scene.getItemIds();
+        const std::vector<unsigned int>& indices = m_scene.getIndices();
+        glBindBuffer(GL_ARRAY_BUFFER, m_sceneVbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, m_sceneItemVbo);
+        glBufferData(GL_ARRAY_BUFFER, item_ids.size() * sizeof(unsigned int), item_ids.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // 不经过 VAO 的绑定点上传，避免改动当前 VAO 记录的索引缓冲区
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_sceneEbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        const std::vector<SceneItem>& items = m_scene.getItems();
+        std::vector<glm::mat4> transforms;
+        transforms.reserve(items.size());
+        m_sceneCounts.clear();
+        m_sceneOffsets.clear();
+        m_sceneBaseVertices.clear();
+        for (const SceneItem& item : items) {
+            transforms.push_back(item.transform);
+            if (item.indexCount == 0) continue;
+            m_sceneCounts.push_back(static_cast<GLsizei>(item.indexCount));
+            m_sceneOffsets.push_back(reinterpret_cast<const void*>(item.indexOffset * sizeof(unsigned int)));
+            m_sceneBaseVertices.push_back(static_cast<GLint>(item.vertexOffset));
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, m_sceneTransformBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, transforms.size() * sizeof(glm::mat4), transforms.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        m_sceneReady = true;
+        requestRedraw();
+    }
+
+    if (m_showScene && m_sceneDirty && !m_sceneTask.valid()) {
+        m_sceneDirty = false;
+        std::vector<SceneItem> items = makeSceneItems();
+        // 整个网格大约占据默认视角下画面的高度
+        float spacing = 3.2f / std::ceil(std::sqrt(static_cast<float>(items.size())));
+        m_sceneTask = std::async(std::launch::async, [this, items, spacing]() {
+            m_pendingScene.build(items, &m_threadPool);
+            m_pendingScene.layoutGrid(spacing);
+            glfwPostEmptyEvent();
+        });
+    }
+}
+
+void Application::renderGraphScene(const glm::mat4& mvp) {
+    glUseProgram(m_sceneProgram);
+    glUniformMatrix4fv(glGetUniformLocation(m_sceneProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(mvp));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, m_sceneTransformTexture);
+    glUniform1i(glGetUniformLocation(m_sceneProgram, "transforms"), 0);
+    glBindVertexArray(m_sceneVao);
+
+    // 所有图形的边一次绘制，各图形的索引从自己的起始顶点开始编号
+    glUniform3f(glGetUniformLocation(m_sceneProgram, "objectColor"), 0.7f, 0.7f, 0.7f);
+    glMultiDrawElementsBaseVertex(GL_LINES, m_sceneCounts.data(), GL_UNSIGNED_INT, m_sceneOffsets.data(),
+        static_cast<GLsizei>(m_sceneCounts.size()), m_sceneBaseVertices.data());
+
+    // 所有图形的点在共享缓冲区中连续存放，一次绘制
+    glUniform3f(glGetUniformLocation(m_sceneProgram, "objectColor"), 0.2f, 0.8f, 0.8f);
+    glPointSize(5.0f);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_scene.getVertices().size()));
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void Application::updateSymmetryBuffers() {
+    if (!TopologyGraph::describeSymmetry(m_params, m_symmetry)) return;
+
+    // 扇区顶点在前，只画一次的固定点接在后面
+    std::vector<glm::vec3> vertices = m_symmetry.sectorVertices;
+    vertices.insert(vertices.end(), m_symmetry.fixedVertices.begin(), m_symmetry.fixedVertices.end());
+
+    glBindVertexArray(m_symmetryVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_symmetryVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_symmetryEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_symmetry.sectorIndices.size() * sizeof(unsigned int), m_symmetry.sectorIndices.data(), GL_DYNAMIC_DRAW);
+    glBindVertexArray(0);
+}
+
+void Application::renderInstanced(const glm::mat4& mvp) {
+    if (m_symmetry.rotationCount == 0) return;
+
+    glUseProgram(m_instancedProgram);
+    glUniformMatrix4fv(glGetUniformLocation(m_instancedProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(mvp));
+    glUniform1i(glGetUniformLocation(m_instancedProgram, "rotationCount"), m_symmetry.rotationCount);
+    glBindVertexArray(m_symmetryVao);
+
+    // 绘制边：每个实例是一个扇区
+    glUniform3f(glGetUniformLocation(m_instancedProgram, "objectColor"), 0.7f, 0.7f, 0.7f);
+    glDrawElementsInstanced(GL_LINES, static_cast<GLsizei>(m_symmetry.sectorIndices.size()), GL_UNSIGNED_INT, 0, m_symmetry.rotationCount);
+
+    // 绘制节点：每个扇区只画自己的点，固定点只画一次（实例 0 不旋转）
+    glUniform3f(glGetUniformLocation(m_instancedProgram, "objectColor"), 0.2f, 0.8f, 0.8f);
+    glPointSize(5.0f);
+    glDrawArraysInstanced(GL_POINTS, 0, static_cast<GLsizei>(m_symmetry.ownedVertexCount), m_symmetry.rotationCount);
+    glDrawArraysInstanced(GL_POINTS, static_cast<GLint>(m_symmetry.sectorVertices.size()), static_cast<GLsizei>(m_symmetry.fixedVertices.size()), 1);
+
+    glBindVertexArray(0);
+}
+
+void Application::renderProcedural(const glm::mat4& mvp) {
+    MeshSize size = TopologyGraph::computeSize(m_params);
+    if (size.vertexCount == 0) return;
+
+    glUseProgram(m_proceduralProgram);
+    glUniformMatrix4fv(glGetUniformLocation(m_proceduralProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(mvp));
+    setProceduralShapeUniforms(m_proceduralProgram, m_params);
+
+    glBindVertexArray(m_proceduralVao);
+
+    // 绘制边：每条边两个顶点
+    glUniform1i(glGetUniformLocation(m_proceduralProgram, "drawLines"), 1);
+    glUniform3f(glGetUniformLocation(m_proceduralProgram, "objectColor"), 0.7f, 0.7f, 0.7f);
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(size.indexCount));
 
     // 绘制节点
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 0.2f, 0.8f, 0.8f);
+    glUniform1i(glGetUniformLocation(m_proceduralProgram, "drawLines"), 0);
+    glUniform3f(glGetUniformLocation(m_proceduralProgram, "objectColor"), 0.2f, 0.8f, 0.8f);
     glPointSize(5.0f);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_graph.getVertexCount()));
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(size.vertexCount));
 
     glBindVertexArray(0);
 }
 
-void Application::updateBuffers() {
+void Application::updateBuffers(GraphChange change) {
+    if (change == GraphChange::NONE) return;
+
+    // 只有顶点坐标变化时索引缓冲区不用重新上传；两个缓冲区内部都只上传和原有内容不同的块
     glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, m_graph.getVertexCount() * sizeof(glm::vec3), m_graph.getVertices().data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_graph.getIndexCount() * sizeof(unsigned int), m_graph.getIndices().data(), GL_STATIC_DRAW);
+    // 有紧凑编码时只上传紧凑数据
+    if (m_graph.getPositionFormat() == PositionFormat::FLOAT32) {
+        m_lastUploadBytes = m_vertexBuffer.update(m_graph.getVertices().data(), m_graph.getVertexCount() * sizeof(glm::vec3));
+    }
+    else {
+        m_lastUploadBytes = m_vertexBuffer.update(m_graph.getPackedPositions().data(), m_graph.getPackedPositions().size() * sizeof(uint16_t));
+    }
+    if (change == GraphChange::TOPOLOGY) {
+        if (m_graph.hasShortIndices()) {
+            m_lastUploadBytes += m_indexBuffer.update(m_graph.getShortIndices().data(), m_graph.getIndexCount() * sizeof(uint16_t));
+        }
+        else {
+            m_lastUploadBytes += m_indexBuffer.update(m_graph.getIndices().data(), m_graph.getIndexCount() * sizeof(unsigned int));
+        }
+    }
+    bindVertexArray();
     glBindVertexArray(0);
 }
 
 void Application::saveFrameToPNG() {
-    // 截图要保存的文件夹名称
-    const std::string directory = "screenshots";
+	// 生成基于当前时间的唯一文件名，主要是解决用户多次截图的覆盖问题
+    std::string filename = makeTimestampedPath("screenshots", ".png");
+    if (filename.empty()) return;
+
+    // 只发出读回命令，像素到达后由线程池编码和写文件，不阻塞当前帧
+    m_capture.requestScreenshot(filename, m_width, m_height);
+}
+
+void Application::startTiledCapture() {
+    std::string filename = makeTimestampedPath("screenshots", "_tiled.png");
+    if (filename.empty()) return;
+
+    // 固定开始时的视角和旋转角度，之后每一块都用同一组矩阵，不受自动旋转和鼠标的影响
+    int width = m_tiledWidth;
+    int height = m_tiledHeight;
+    glm::mat4 view = glm::lookAt(m_cameraPos, m_cameraPos + m_cameraFront, m_cameraUp);
+    glm::mat4 proj = glm::perspective(glm::radians(m_fov), (float)width / height, 0.1f, 100.0f);
+    glm::mat4 model = getModelMatrix();
+    m_capture.startTiledCapture(filename, width, height, [this, view, proj, model, height](const glm::mat4& tileTransform) {
+        glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawScene(view, tileTransform * proj, model, static_cast<float>(height));
+    });
+}
 
-	// 检查文件夹是否存在，如果不存在则创建
+std::string Application::makeTimestampedPath(const std::string& directory, const std::string& extension) {
     DWORD attributes = GetFileAttributesA(directory.c_str());
     if (attributes == INVALID_FILE_ATTRIBUTES) {
-        // 文件夹不存在，尝试创建
         if (CreateDirectoryA(directory.c_str(), NULL)) {
-            std::cout << "创建截图文件夹: " << directory << std::endl;
+            std::cout << "创建文件夹: " << directory << std::endl;
         }
         else {
-            std::cerr << "创建截图文件夹失败!" << std::endl;
-            return; // 创建失败则不继续
+            std::cerr << "创建文件夹失败: " << directory << std::endl;
+            return std::string();
         }
     }
 
-	// 生成基于当前时间的唯一文件名，主要是解决用户多次截图的覆盖问题
-    // 获取当前时间
     time_t now = time(0);
-
-    // 将时间转换为本地时间结构体
     tm t_struct;
-    localtime_s(&t_struct, &now); 
-
-    // 定义一个缓冲区来存储格式化后的时间字符串
+    localtime_s(&t_struct, &now);
     char timestamp_buffer[80];
-
-    // 使用 strftime 格式化时间
     strftime(timestamp_buffer, sizeof(timestamp_buffer), "%Y-%m-%d_%H-%M-%S", &t_struct);
+    return directory + "/topology_" + timestamp_buffer + extension;
+}
 
-    // 组合成完整的文件路径
-    std::string filename = directory + "/topology_" + timestamp_buffer + ".png";
-
-    // 读取像素并保存文件 
-    std::vector<unsigned char> pixels(m_width * m_height * 3);
-    glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
-    stbi_flip_vertically_on_write(1);
-    if (stbi_write_png(filename.c_str(), m_width, m_height, 3, pixels.data(), m_width * 3)) {
-        std::cout << "截图已保存到: " << filename << std::endl;
-    }
-    else {
-        std::cerr << "错误: 无法保存截图到 " << filename << std::endl;
-    }
+void Application::exportMesh() {
+    // 和截图一样用当前时间命名，避免多次导出互相覆盖
+    std::string path = makeTimestampedPath("exports", MeshExporter::getExtension(m_exportFormat));
+    if (path.empty()) return;
+    m_exportPath = path;
+    m_exportStatus.clear();
+
+    // 导出直接读取 m_graph，不复制数据；导出结束前渲染线程不会换入新的图形
+    MeshExporter::Format format = m_exportFormat;
+    m_exportTask = std::async(std::launch::async, [this, format, path]() {
+        bool ok = MeshExporter::exportMesh(m_graph, path, format, &m_threadPool);
+        if (ok) std::cout << "网格已导出到: " << path << std::endl;
+        else std::cerr << "错误: 无法导出网格到 " << path << std::endl;
+        glfwPostEmptyEvent();
+        return ok;
+    });
 }
 
 // 清理函数
 void Application::cleanup() {
+    // 写完还没保存的截图，编码任务在线程池中
+    m_capture.destroy();
+
+    // 等待导出、分析和分块结束，它们的线程还在读取 m_graph
+    if (m_exportTask.valid()) m_exportTask.wait();
+    if (m_analyticsTask.valid()) m_analyticsTask.wait();
+    if (m_chunkTask.valid()) m_chunkTask.wait();
+    if (m_sceneTask.valid()) m_sceneTask.wait();
+    // 预测线程完成时会调用 glfwPostEmptyEvent，在 glfwTerminate 之前停下
+    m_speculator.setThreadCount(0);
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     glDeleteVertexArrays(1, &m_vao);
-    glDeleteBuffers(1, &m_vbo);
-    glDeleteBuffers(1, &m_ebo);
+    GraphCache::releaseMesh(m_residentMesh);
+    m_graphCache.destroy();
+    m_vertexBuffer.destroy();
+    m_indexBuffer.destroy();
     glDeleteProgram(m_shaderProgram);
+    glDeleteProgram(m_proceduralProgram);
+    glDeleteProgram(m_instancedProgram);
+    glDeleteVertexArrays(1, &m_proceduralVao);
+    glDeleteVertexArrays(1, &m_symmetryVao);
+    glDeleteBuffers(1, &m_symmetryVbo);
+    glDeleteBuffers(1, &m_symmetryEbo);
+    glDeleteBuffers(1, &m_chunkEbo);
+    glDeleteProgram(m_sceneProgram);
+    glDeleteVertexArrays(1, &m_sceneVao);
+    glDeleteBuffers(1, &m_sceneVbo);
+    glDeleteBuffers(1, &m_sceneItemVbo);
+    glDeleteBuffers(1, &m_sceneEbo);
+    glDeleteBuffers(1, &m_sceneTransformBuffer);
+    glDeleteTextures(1, &m_sceneTransformTexture);
+    m_profiler.destroy();
 
     if (m_window) {
         glfwDestroyWindow(m_window);
@@ -416,14 +1483,38 @@ void Application::scroll_callback(GLFWwindow* window, double xoffset, double yof
     if (app) app->onMouseScroll(yoffset);
 }
 
+void Application::mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app) app->requestRedraw();
+}
+
+void Application::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app) app->requestRedraw();
+}
+
+void Application::char_callback(GLFWwindow* window, unsigned int codepoint) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app) app->requestRedraw();
+}
+
+void Application::window_refresh_callback(GLFWwindow* window) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app) app->requestRedraw();
+}
+
 // 成员回调
 void Application::onFramebufferSize(int width, int height) {
+    requestRedraw();
     m_width = width;
     m_height = height;
     glViewport(0, 0, width, height);
 }
 
 void Application::onMouseMove(double xpos, double ypos) {
+    // 鼠标移动会改变界面的悬停状态，即使不旋转也要重绘
+    requestRedraw();
+
     // 仅在鼠标右键按下时才处理旋转
     if (glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_RIGHT) != GLFW_PRESS) {
         m_firstMouse = true;
@@ -453,6 +1544,7 @@ void Application::onMouseMove(double xpos, double ypos) {
 }
 
 void Application::onMouseScroll(double yoffset) {
+    requestRedraw();
     m_fov -= (float)yoffset;
     if (m_fov < 1.0f) m_fov = 1.0f;
     if (m_fov > 60.0f) m_fov = 60.0f;
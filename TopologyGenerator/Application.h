@@ -1,32 +1,46 @@
 #pragma once
 
 #include "TopologyGraph.h" 
+#include "ThreadPool.h"
+#include "AsyncGenerator.h"
+#include "StreamBuffer.h"
+#include "MeshExporter.h"
+#include "GraphAnalytics.h"
+#include "ChunkedMesh.h"
+#include "GraphScene.h"
+#include "FrameProfiler.h"
+#include "ScreenCapture.h"
+#include "MeshCache.h"
+#include "GraphCache.h"
+#include "SpeculativeGenerator.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <string>
+#include <future>
 
-class Application {
-public:
-    Application(unsigned int width, unsigned int height, const char* title);
-    ~Application();
-
-
-    void run();
-
-private:
-    // --- 鎴愬憳鍙橀噺 ---
-    // 绐楀彛
-    GLFWwindow* m_window;
-    unsigned int m_width;
-    unsigned int m_height;
-    std::string m_title;
-
-    // 鏁版嵁鍜岀姸鎬#pragma once
+// 娓叉煋璺#pragma once
 
 #include "TopologyGraph.h" 
+#include "ThreadPool.h"
+#include "AsyncGenerator.h"
+#include "StreamBuffer.h"
+#include "MeshExporter.h"
+#include "GraphAnalytics.h"
+#include "ChunkedMesh.h"
+#include "GraphScene.h"
+#include "FrameProfiler.h"
+#include "ScreenCapture.h"
+#include "MeshCache.h"
+#include "GraphCache.h"
+#include "SpeculativeGenerator.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <string>
+#include <future>
+
+// 渲染路径：CPU 生成完整的顶点和索引缓冲区、GPU 按 gl_VertexID 程序化生成、只上传一个扇区并实例化绘制、
+// CPU 生成后分块并按视锥剔除和 LOD 绘制（大规模模式）
+enum class RenderMode { BUFFERS, PROCEDURAL, INSTANCED, CHUNKED };
 
 class Application {
 public:
@@ -47,10 +61,60 @@ private:
     // 数据和状态
     TopologyGraph m_graph;
     Parameters m_params;
+    // 大规模图形按扇区 / 主段并行生成
+    ThreadPool m_threadPool;
+    // 生成较慢的图形写入磁盘缓存，下次启动或切回同样的参数时直接映射文件；必须在 m_generator 之前构造
+    MeshCache m_meshCache;
+    // 在后台线程生成图形，渲染线程每帧取一次结果，m_graph 始终是已上传到 GPU 的那份数据
+    AsyncGenerator m_generator;
+    // 拖动整数滑动条时在低优先级线程里提前生成相邻的值，结果上传后放进 m_graphCache
+    SpeculativeGenerator m_speculator;
+    // 本帧正在拖动的整数滑动条对应的参数字段和范围，没有时为 nullptr
+    int Parameters::* m_dragField = nullptr;
+    int m_dragMin = 0;
+    int m_dragMax = 0;
+    // 最近一次拖动的方向（1 或 -1），松开后清零；先预测拖动方向上的值
+    int m_dragDirection = 0;
+    // 上一次交给 m_speculator 的候选，候选不变时不重新提交
+    std::vector<Parameters> m_speculated;
+
+    // 渐进细化：按住控件修改大图形时先生成抽稀的预览，松开或者停下 kSettleSeconds 后再生成完整图形
+    bool m_progressivePreview = true;
+    // 预览的顶点数上限（千），拖动时的延迟只取决于它
+    int m_previewPointsK = 100;
+    // 最近一次请求的是预览（还在生成或者已经显示），之后要补上完整图形
+    bool m_requestedPreview = false;
+    // m_graph 是预览，不放进 m_graphCache
+    bool m_graphIsPreview = false;
+    // 本帧是否有界面控件正被按住
+    bool m_inputActive = false;
+    // 最近一次修改参数的时间
+    double m_lastEditTime = 0.0;
+    static constexpr double kSettleSeconds = 0.3;
 
     // 渲染相关
     unsigned int m_shaderProgram;
-    unsigned int m_vao, m_vbo, m_ebo;
+    // GPU 程序化模式：顶点坐标由着色器根据 gl_VertexID 计算，不需要顶点和索引缓冲区
+    unsigned int m_proceduralProgram;
+    // 实例化模式：只上传一个扇区，按 gl_InstanceID 旋转出其余扇区
+    unsigned int m_instancedProgram;
+    unsigned int m_vao;
+    unsigned int m_proceduralVao;
+    unsigned int m_symmetryVao, m_symmetryVbo, m_symmetryEbo;
+    SymmetricMesh m_symmetry;
+    // 界面上选择的渲染路径，以及上一帧实际使用的渲染路径（当前形状不支持时退回 BUFFERS）
+    RenderMode m_renderMode = RenderMode::BUFFERS;
+    RenderMode m_activeRenderMode = RenderMode::BUFFERS;
+    // 顶点和索引缓冲区，容量只增不减，只上传变化的部分
+    StreamBuffer m_vertexBuffer;
+    StreamBuffer m_indexBuffer;
+    // 最近一次更新实际上传的字节数，显示在界面上
+    size_t m_lastUploadBytes = 0;
+    // 最近用过的图形及其 GPU 缓冲区；m_graph 换出时放进去，参数回到用过的值时换回来
+    GraphCache m_graphCache;
+    // m_graph 来自 m_graphCache 时绘制它自己的 VAO，流式缓冲区中仍是之前的数据
+    ResidentMesh m_residentMesh;
+    bool m_drawResident = false;
 
     // 摄像机/视图控制
     glm::vec3 m_cameraPos;
@@ -74,6 +138,73 @@ private:
 
     //用于判断是否截图
     bool m_takeScreenshot = false;
+    // 截图的异步读回和编码，以及分块截图
+    ScreenCapture m_capture;
+    // 分块截图的尺寸
+    int m_tiledWidth = 8192;
+    int m_tiledHeight = 8192;
+    static const int kMaxTiledSize = 16384;
+
+    // 网格导出：在后台线程把 m_graph 写入文件，导出期间不换入新的生成结果
+    MeshExporter::Format m_exportFormat = MeshExporter::Format::OBJ;
+    std::future<bool> m_exportTask;
+    std::string m_exportPath;
+    std::string m_exportStatus;
+
+    // 图分析：同样在后台线程读取 m_graph，计算期间也不换入新的生成结果
+    bool m_showAnalytics = false;
+    int m_bfsSource = 0;
+    std::future<GraphMetrics> m_analyticsTask;
+    GraphMetrics m_metrics;
+    bool m_hasMetrics = false;
+    // 图形或 BFS 起点变化后需要重新计算
+    bool m_metricsDirty = true;
+
+    // 大规模模式：后台线程把 m_graph 切块并生成 LOD，计算期间不换入新的生成结果，完成前退回整体绘制
+    ChunkedMesh m_chunks;
+    ChunkedMesh m_pendingChunks;
+    std::future<void> m_chunkTask;
+    bool m_chunksDirty = true;
+    bool m_chunksReady = false;
+    // 所有块、所有级别的索引，和 m_vertexBuffer 中的顶点配合使用
+    unsigned int m_chunkEbo = 0;
+    // 每帧合并绘制的参数，复用容量
+    std::vector<GLsizei> m_drawCounts;
+    std::vector<const void*> m_drawOffsets;
+    std::vector<GLint> m_drawBaseVertices;
+    // 上一帧可见的块数和实际绘制的边数，显示在界面上
+    size_t m_visibleChunks = 0;
+    size_t m_drawnEdges = 0;
+
+    // 对比场景：把当前参数的若干变体排成网格一起绘制，主要参数依次增加 m_sceneStep
+    // 所有图形共用一组顶点和索引缓冲区，每帧固定两次绘制调用，与图形数量无关
+    bool m_showScene = false;
+    int m_sceneVariants = 16;
+    int m_sceneStep = 1;
+    GraphScene m_scene;
+    GraphScene m_pendingScene;
+    std::future<void> m_sceneTask;
+    bool m_sceneDirty = true;
+    bool m_sceneReady = false;
+    unsigned int m_sceneProgram = 0;
+    unsigned int m_sceneVao = 0, m_sceneVbo = 0, m_sceneItemVbo = 0, m_sceneEbo = 0;
+    // 每个图形的变换矩阵存放在纹理缓冲区中，着色器按顶点上的图形序号读取
+    unsigned int m_sceneTransformBuffer = 0, m_sceneTransformTexture = 0;
+    // 合并绘制边的参数，场景换入时计算一次
+    std::vector<GLsizei> m_sceneCounts;
+    std::vector<const void*> m_sceneOffsets;
+    std::vector<GLint> m_sceneBaseVertices;
+
+    // 节能模式：没有变化时不重绘，阻塞等待事件
+    bool m_powerSaving = true;
+    // 还需要重绘的帧数；ImGui 处理一次输入后要再画几帧，悬停和布局才会稳定
+    int m_redrawFrames = 0;
+    static const int kRedrawFrames = 3;
+
+    // 主循环各阶段的 CPU / GPU 耗时
+    FrameProfiler m_profiler;
+    bool m_showProfiler = false;
+    std::string m_profileStatus;
 
     // --- 初始化和清理 ---
     void initWindow();
@@ -81,15 +212,81 @@ private:
     void initImGui();
     void initOpenGLOptions();
     void initShaders();
+    unsigned int createProgram(const char* vertexSrc, const char* fragmentSrc);
     void initBuffers();
+    // 把当前的顶点和索引缓冲区绑定到 VAO（缓冲区扩容后对象可能重建）
+    void bindVertexArray();
+    // 按坐标编码设置当前 VAO 的顶点属性 0，顶点缓冲区需要已经绑定到 GL_ARRAY_BUFFER
+    static void setPositionAttribute(PositionFormat format);
     void cleanup();
 
     // --- 主循环中的各项任务 ---
     void mainLoop();
+    // 自动旋转、分块截图或者关闭节能模式时每帧都重绘
+    bool needsContinuousRedraw() const;
+    // 没有需要重绘的帧时阻塞到下一个事件（或者截图读回的轮询时间）
+    void waitForChanges();
+    // 输入、窗口变化或者新数据换入后调用，之后重绘 kRedrawFrames 帧
+    void requestRedraw() { m_redrawFrames = kRedrawFrames; }
     void renderUI();
+    // 推进自动旋转，按窗口的视角绘制场景
     void renderScene();
-    void updateBuffers();
+    // 用给定的矩阵绘制当前渲染路径的场景，分块截图的每一块也通过它绘制
+    void drawScene(const glm::mat4& view, const glm::mat4& proj, const glm::mat4& model, float viewportHeight);
+    glm::mat4 getModelMatrix() const;
+    // 当前形状和选项下实际使用的渲染路径：程序化模式只支持不美化的球体和圆环，实例化模式只支持 2D 拓扑图和球体
+    RenderMode getActiveRenderMode() const;
+    // 该渲染路径是否使用 CPU 生成的完整图形（m_graph 和顶点、索引缓冲区）
+    static bool usesCpuGraph(RenderMode mode) { return mode == RenderMode::BUFFERS || mode == RenderMode::CHUNKED; }
+    // 是否有后台任务正在读取 m_graph
+    bool isGraphBusy() const { return m_exportTask.valid() || m_analyticsTask.valid() || m_chunkTask.valid(); }
+    void renderProcedural(const glm::mat4& mvp);
+    void renderInstanced(const glm::mat4& mvp);
+    // 剔除视锥外的块，按块到相机的距离选择 LOD，合并成一次绘制调用
+    // viewportHeight 为整个画面的像素高度，用于估算投影大小
+    void renderChunked(const glm::mat4& mvp, const glm::mat4& modelView, GLint baseVertex, float viewportHeight);
+    // 需要时在后台线程重新分块，完成后上传索引
+    void updateChunks(RenderMode activeMode);
+    // 用共享缓冲区合并绘制对比场景中的所有图形
+    void renderGraphScene(const glm::mat4& mvp);
+    // 换入后台生成的场景并上传，参数变化后在后台线程重新生成
+    void updateScene();
+    // 按当前参数生成对比场景中各变体的参数
+    std::vector<SceneItem> makeSceneItems() const;
+    // 重新生成扇区数据并上传到实例化绘制用的缓冲区
+    void updateSymmetryBuffers();
+    // 按 m_params 更新 m_graph：缓存中有相同参数的图形时直接换入，否则交给后台线程生成
+    // allowPreview 为 true 且控件正被按住时，大图形只生成抽稀的预览
+    void requestGraph(bool allowPreview);
+    // 换出 m_graph 之前调用：放得进预算时连同 GPU 数据移入 m_graphCache，之后 m_graph 为空
+    void retainGraph();
+    // 为 graph 创建一份独立的 GPU 缓冲区：fromStreamBuffers 为 true 时 graph 必须是 m_graph，数据在 GPU 上从流式缓冲区复制，
+    // 否则从 graph 的 CPU 数据上传
+    ResidentMesh createResidentMesh(const TopologyGraph& graph, bool fromStreamBuffers);
+    // 整数参数的滑动条，拖动时记录字段和范围供预测生成使用
+    bool parameterSlider(const char* label, int Parameters::* field, int min, int max);
+    // 按正在拖动的滑动条更新预测生成的候选，没有拖动时取消预测
+    void updateSpeculation(RenderMode activeMode);
+    // 取走预测生成的结果，上传后放进 m_graphCache；正好是当前要的参数时直接换入
+    void fetchSpeculation();
+    // m_graph 被换掉之后，标记依赖它的分析和分块需要重新计算
+    void onGraphReplaced(GraphChange change);
+    // 换入后台生成的新图形并启动读取它的后台任务，返回变化程度，没有换入时为 NONE
+    GraphChange fetchGraph();
+    // 按图形的变化程度上传：只变坐标时只更新顶点缓冲区
+    void updateBuffers(GraphChange change);
+    // 异步截取当前窗口，文件写到 screenshots 文件夹
     void saveFrameToPNG();
+    // 固定当前视角，按 m_tiledWidth x m_tiledHeight 开始分块截图
+    void startTiledCapture();
+    // 在后台线程导出当前图形，文件写到 exports 文件夹
+    void exportMesh();
+    // 显示图分析结果，需要时在后台线程重新计算
+    void renderAnalytics();
+    // 显示各阶段耗时的分位数，可以把最近若干帧导出到 profiles 文件夹
+    void renderProfiler();
+    // 在 directory 下生成以当前时间命名的文件路径，文件夹不存在时创建，失败时返回空字符串
+    static std::string makeTimestampedPath(const std::string& directory, const std::string& extension);
 
     // --- 回调函数的成员版本 ---
     void onFramebufferSize(int width, int height);
@@ -100,4 +297,8 @@ private:
     static void framebuffer_size_callback(GLFWwindow* window, int width, int height);
     static void mouse_callback(GLFWwindow* window, double xpos, double ypos);
     static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+    static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+    static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void char_callback(GLFWwindow* window, unsigned int codepoint);
+    static void window_refresh_callback(GLFWwindow* window);
 };
\ No newline at end of file
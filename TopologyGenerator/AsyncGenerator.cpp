@@ -0,0 +1,131 @@
+#include "AsyncGenerator.h"
+#include <utility>
+
+namespace {
+
+// 闄ゅ嚑浣曞弬鏁板#include "AsyncGenerator.h"
+#include <utility>
+
+namespace {
+
+// 除几何参数外还有其他拓扑参数不同；开启焊接时几何参数的变化也要整体重建，这里不算在内
+bool changesTopologyParameters(const Parameters& before, const Parameters& after) {
+    if (TopologyGraph::classifyChange(before, after) != GraphChange::TOPOLOGY) return false;
+    if (!before.weld_vertices || !after.weld_vertices) return true;
+    Parameters unwelded_before = before;
+    Parameters unwelded_after = after;
+    unwelded_before.weld_vertices = false;
+    unwelded_after.weld_vertices = false;
+    return TopologyGraph::classifyChange(unwelded_before, unwelded_after) == GraphChange::TOPOLOGY;
+}
+
+}
+
+AsyncGenerator::AsyncGenerator(ThreadPool* pool)
+    : m_threadPool(pool) {
+    m_worker = std::thread(&AsyncGenerator::workerLoop, this);
+}
+
+AsyncGenerator::~AsyncGenerator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cancel = true;
+    m_requestCv.notify_one();
+    m_worker.join();
+}
+
+void AsyncGenerator::request(const Parameters& params) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingParams = params;
+        m_hasRequest = true;
+        // 旧结果已经过时，不再交给渲染线程
+        m_ready = false;
+    }
+    m_cancel = true;
+    m_requestCv.notify_one();
+}
+
+void AsyncGenerator::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_hasRequest = false;
+        m_ready = false;
+    }
+    m_cancel = true;
+}
+
+bool AsyncGenerator::isReady() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ready;
+}
+
+bool AsyncGenerator::fetch(TopologyGraph& front, GraphChange& change) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_ready) return false;
+
+    // 两个缓冲区各自记录自己的参数，交换后后台缓冲区下一次生成仍能判断是否只需更新坐标
+    change = front.hasGenerated() ? TopologyGraph::classifyChange(front.getParameters(), m_back.getParameters())
+        : GraphChange::TOPOLOGY;
+    std::swap(front, m_back);
+    front.setCancelFlag(nullptr);
+    m_ready = false;
+    return true;
+}
+
+bool AsyncGenerator::fetch(TopologyGraph& front, GraphChange& change, const std::function<void(TopologyGraph&)>& retire) {
+    bool retire_front = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_ready) return false;
+        retire_front = !front.hasGenerated() || changesTopologyParameters(front.getParameters(), m_back.getParameters());
+    }
+    // retire 可能很慢（例如复制 GPU 数据），不持有锁调用；只有渲染线程会清除就绪标志，之后的 fetch 一定成功
+    if (retire_front && retire) retire(front);
+    return fetch(front, change);
+}
+
+AsyncGenerator::Stats AsyncGenerator::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool AsyncGenerator::isBusy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasRequest || m_working;
+}
+
+void AsyncGenerator::workerLoop() {
+    for (;;) {
+        Parameters params;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestCv.wait(lock, [this] { return m_stop || m_hasRequest; });
+            if (m_stop) return;
+            params = m_pendingParams;
+            m_hasRequest = false;
+            m_working = true;
+            // 在锁内清除取消标志，之后到达的请求一定能取消这次生成
+            m_cancel = false;
+        }
+
+        m_back.setThreadPool(m_threadPool);
+        m_back.setCancelFlag(&m_cancel);
+        m_back.setMeshCache(m_meshCache);
+        GraphChange change = m_back.generate(params);
+
+        bool ready = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_working = false;
+            // 被取消或者已经有更新的请求时丢弃这次结果
+            m_ready = !m_cancel && !m_hasRequest && m_back.hasGenerated();
+            ready = m_ready;
+            if (ready && change == GraphChange::POSITIONS) ++m_stats.positionUpdates;
+            else if (ready && change == GraphChange::TOPOLOGY) ++m_stats.rebuilds;
+        }
+        if (ready && m_readyCallback) m_readyCallback();
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "TopologyGraph.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// 鍚庡彴鐢熸垚鍣#pragma once
+#include "TopologyGraph.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// 后台生成器：在单独的工作线程里生成图形，渲染线程只负责取结果和上传
+// 工作线程写后台缓冲区，完成后标记为就绪，渲染线程取结果时和自己的图形整体交换（只交换指针，不复制数据）
+// 新参数到达时取消正在进行的生成，始终只保留最新的一次请求
+class AsyncGenerator {
+public:
+    // pool 用于单次生成内部的并行，可以为 nullptr
+    explicit AsyncGenerator(ThreadPool* pool = nullptr);
+    ~AsyncGenerator();
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    // 提交新参数，覆盖尚未开始的请求并取消正在进行的生成
+    void request(const Parameters& params);
+
+    // 丢弃尚未开始的请求和尚未取走的结果，并取消正在进行的生成
+    void cancel();
+
+    // 是否有新完成的结果可以取；只能在渲染线程调用，返回 true 后紧接着的 fetch 一定成功
+    bool isReady() const;
+
+    // 如果有新完成的结果，和 front 交换并返回 true，change 为相对 front 原有数据的变化程度
+    // 只能在渲染线程调用
+    bool fetch(TopologyGraph& front, GraphChange& change);
+    // 同上，但新结果改变了拓扑参数时先把 front 交给 retire（例如放进缓存），再换入新结果
+    // 只改变几何参数（圆环半径、立方体棱长）时不调用 retire：front 留给工作线程作为下一次只更新坐标的工作区，
+    // 拖动连续的滑动条时也不会每个值都交出一个图形
+    bool fetch(TopologyGraph& front, GraphChange& change, const std::function<void(TopologyGraph&)>& retire);
+
+    // 是否有请求正在排队或生成
+    bool isBusy() const;
+
+    // 有新结果可以取时在工作线程调用，用于唤醒等待事件的渲染线程；必须在第一次 request 之前设置
+    void setReadyCallback(std::function<void()> callback) { m_readyCallback = std::move(callback); }
+
+    // 工作线程生成时使用的磁盘缓存，可以为 nullptr；必须在第一次 request 之前设置
+    void setMeshCache(MeshCache* cache) { m_meshCache = cache; }
+
+    // 交给渲染线程的结果中，整体重建和只更新坐标的次数
+    struct Stats {
+        size_t rebuilds = 0;
+        size_t positionUpdates = 0;
+    };
+    Stats getStats() const;
+
+private:
+    ThreadPool* m_threadPool;
+    MeshCache* m_meshCache = nullptr;
+    std::thread m_worker;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_requestCv;
+
+    // 后台缓冲区，生成期间只有工作线程访问，其余时间受 m_mutex 保护
+    TopologyGraph m_back;
+    Parameters m_pendingParams;
+    bool m_hasRequest = false;
+    bool m_working = false;
+    bool m_ready = false;
+    bool m_stop = false;
+    Stats m_stats;
+
+    std::function<void()> m_readyCallback;
+
+    // 新请求到达时置为 true，让正在进行的生成提前结束
+    std::atomic<bool> m_cancel{ false };
+
+    void workerLoop();
+};
@@ -0,0 +1,192 @@
+// 鏃犵晫闈㈢殑鎵归噺鐢熸垚宸ュ叿锛氬// 无界面的批量生成工具：对 Parameters 做参数扫描，多线程生成所有组合并写入磁盘
+// 只依赖 TopologyGraph，不需要 GLFW / glad / ImGui / windows.h，可以在没有显示器的 Linux 机器上运行
+#include "TopologyGraph.h"
+#include "MeshExporter.h"
+#include "ThreadPool.h"
+#include "GraphAnalytics.h"
+#include "CommandLine.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+std::vector<MeshExporter::Format> parseFormats(const std::string& text) {
+    std::vector<MeshExporter::Format> formats;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string name = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = (comma == std::string::npos) ? text.size() + 1 : comma + 1;
+        if (name.empty()) continue;
+        if (name == "obj") formats.push_back(MeshExporter::Format::OBJ);
+        else if (name == "ply") formats.push_back(MeshExporter::Format::PLY);
+        else if (name == "gltf") formats.push_back(MeshExporter::Format::GLTF);
+        else throw std::invalid_argument("unknown format '" + name + "'");
+    }
+    if (formats.empty()) throw std::invalid_argument("empty list for --format");
+    return formats;
+}
+
+// 批量生成的配置
+struct SweepOptions {
+    ParameterSweep sweep;
+    std::vector<MeshExporter::Format> formats{ MeshExporter::Format::OBJ };
+    std::string outputDir = "batch_output";
+    unsigned int threads = 0;
+    bool dryRun = false;
+    bool weld = false;
+    bool analyze = false;
+};
+
+void printUsage() {
+    std::cout <<
+        "Usage: TopologyBatch [options]\n"
+        "Generates every combination of the given parameter lists and writes each mesh in every requested format.\n"
+        << kSweepUsage <<
+        "  --format LIST         obj, ply (binary) and/or gltf (.gltf + .bin) (default: obj)\n"
+        "  --out DIR             output directory (default: batch_output)\n"
+        "  --threads N           worker threads (default: all cores)\n"
+        "  --weld                merge coincident points and drop duplicate / degenerate edges\n"
+        "  --analyze             print degree range, connected components, eccentricity of point 0\n"
+        "                        and approximate diameter of every mesh\n"
+        "  --dry-run             only print the number of combinations and total mesh size\n"
+        "                        (with --weld this is the size before welding)\n"
+        "  --help                show this message\n";
+}
+
+SweepOptions parseOptions(int argc, char** argv) {
+    SweepOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (arg == "--dry-run") {
+            options.dryRun = true;
+            continue;
+        }
+        if (arg == "--weld") {
+            options.weld = true;
+            continue;
+        }
+        if (arg == "--analyze") {
+            options.analyze = true;
+            continue;
+        }
+        if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+        std::string value = argv[++i];
+
+        if (parseSweepOption(arg, value, options.sweep)) continue;
+
+        if (arg == "--format") options.formats = parseFormats(value);
+        else if (arg == "--out") options.outputDir = value;
+        else if (arg == "--threads") options.threads = static_cast<unsigned int>(parseList<int>(arg, value).front());
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+    return options;
+}
+
+}
+
+int main(int argc, char** argv) {
+    SweepOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Parameters> jobs = expandSweep(options.sweep, options.weld);
+    std::cout << "Combinations: " << jobs.size() << std::endl;
+
+    // 不生成网格，直接按公式统计整个扫描的规模
+    if (options.dryRun) {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        for (const Parameters& params : jobs) {
+            MeshSize size = TopologyGraph::computeSize(params);
+            vertexCount += size.vertexCount;
+            indexCount += size.indexCount;
+        }
+        std::cout << "Total: " << vertexCount << " vertices, " << indexCount / 2 << " edges" << std::endl;
+        return 0;
+    }
+    if (jobs.empty()) return 0;
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    if (ec) {
+        std::cerr << "Error: cannot create output directory " << options.outputDir << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(options.threads);
+    std::cout << "Worker threads: " << pool.getThreadCount() << std::endl;
+
+    std::atomic<size_t> finished{ 0 };
+    std::atomic<size_t> failed{ 0 };
+    std::atomic<size_t> totalVertices{ 0 };
+    std::atomic<size_t> totalEdges{ 0 };
+    auto startTime = std::chrono::steady_clock::now();
+
+    // 每个组合一个任务，各任务使用独立的 TopologyGraph，互不共享数据
+    for (const Parameters& params : jobs) {
+        pool.submit([&, params]() {
+            // 组合数少于线程数时，单个大网格也能借助空闲线程并行生成
+            TopologyGraph graph;
+            graph.setThreadPool(&pool);
+            graph.generate(params);
+
+            bool ok = true;
+            for (MeshExporter::Format format : options.formats) {
+                std::string path = (std::filesystem::path(options.outputDir) /
+                    (makeFileName(params) + MeshExporter::getExtension(format))).string();
+                if (!MeshExporter::exportMesh(graph, path, format, &pool)) {
+                    ok = false;
+                    std::cerr << "Error: failed to write " + path + "\n";
+                }
+            }
+            // 统计结果整行拼好再输出，避免多个线程的输出交错
+            if (options.analyze) {
+                GraphMetrics metrics = GraphAnalytics::analyze(graph, 0, &pool);
+                char line[256];
+                std::snprintf(line, sizeof(line),
+                    "%s: %zu points, %zu edges, degree %zu/%.2f/%zu, %zu components (largest %zu), eccentricity(0) %u, diameter >= %u\n",
+                    makeFileName(params).c_str(), metrics.vertexCount, metrics.edgeCount,
+                    metrics.minDegree, metrics.averageDegree, metrics.maxDegree,
+                    metrics.componentCount, metrics.largestComponentSize, metrics.eccentricity, metrics.approximateDiameter);
+                std::cout << line;
+            }
+            if (ok) {
+                totalVertices += graph.getVertexCount();
+                totalEdges += graph.getIndexCount() / 2;
+            }
+            else {
+                ++failed;
+            }
+
+            size_t done = ++finished;
+            if (done % 100 == 0 || done == jobs.size()) {
+                std::cout << "[" + std::to_string(done) + "/" + std::to_string(jobs.size()) + "]\n";
+            }
+        });
+    }
+    pool.wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Wrote " << (jobs.size() - failed) << " meshes (" << totalVertices << " vertices, "
+        << totalEdges << " edges) to " << options.outputDir << " in " << seconds << " s" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
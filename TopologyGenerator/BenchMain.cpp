@@ -0,0 +1,336 @@
+// 鏃犵晫闈㈢殑鐢熸垚鎬ц兘娴嬭瘯锛氬// 无界面的生成性能测试：对不同形状、美化开关和分辨率反复调用 TopologyGraph::generate，
+// 统计吞吐量、每个元素的耗时、分配次数和堆内存峰值，结果以 JSON 输出，便于比较不同版本
+#include "TopologyGraph.h"
+#include "ThreadPool.h"
+#include "CommandLine.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// 全局堆分配统计：每块内存前面留一个头记录大小，释放时扣除
+// 只替换普通的 operator new，按对齐要求分配的版本不经过这里（生成代码中没有超对齐的类型）
+std::atomic<size_t> g_allocationCount{ 0 };
+std::atomic<size_t> g_allocatedBytes{ 0 };
+std::atomic<size_t> g_liveBytes{ 0 };
+std::atomic<size_t> g_peakBytes{ 0 };
+const size_t kAllocationHeader = alignof(std::max_align_t);
+
+void* trackedAllocate(size_t size) noexcept {
+    void* block = std::malloc(size + kAllocationHeader);
+    if (!block) return nullptr;
+    *static_cast<size_t*>(block) = size;
+
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    size_t live = g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = g_peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(block) + kAllocationHeader;
+}
+
+void trackedFree(void* ptr) noexcept {
+    if (!ptr) return;
+    char* block = static_cast<char*>(ptr) - kAllocationHeader;
+    g_liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+}
+
+void* operator new(size_t size) {
+    void* ptr = trackedAllocate(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+void* operator new[](size_t size) {
+    void* ptr = trackedAllocate(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+
+namespace {
+
+// 测试配置：每个形状按同一组分辨率 N 展开
+// 2D 拓扑图 N 个子结构；球体 N 个子结构、N/2 层；圆环 N 个主段、N/2 个管段；立方体每条棱 N/16 段
+struct BenchOptions {
+    std::vector<ShapeType> shapes{ ShapeType::TOPOLOGY_2D, ShapeType::SPHERE, ShapeType::TORUS };
+    std::vector<int> beautify{ 0, 1 };
+    std::vector<int> sizes{ 32, 128, 512, 2048 };
+    int repeat = 5;
+    // 1 为单线程生成，0 为使用全部硬件线程
+    unsigned int threads = 1;
+    bool weld = false;
+    std::string outputPath;
+};
+
+// 一个参数组合的测试结果，耗时只包括 generate 本身
+struct BenchResult {
+    Parameters params;
+    int size = 0;
+    size_t vertexCount = 0;
+    size_t edgeCount = 0;
+    double minSeconds = 0.0;
+    double medianSeconds = 0.0;
+    // 单次生成的分配次数、分配总字节数和相对生成前的堆内存峰值
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+    size_t peakBytes = 0;
+};
+
+void printUsage() {
+    std::cout <<
+        "Usage: TopologyBench [options]\n"
+        "Times TopologyGraph::generate for every shape / beautify / size combination and writes the results as JSON.\n"
+        "A LIST is comma separated values or inclusive ranges start:end[:step], e.g. 3,5,8 or 4:100:8\n"
+        "\n"
+        "  --shape LIST     2d, sphere, torus, cube (default: 2d,sphere,torus)\n"
+        "  --beautify LIST  0 and/or 1 (default: 0,1)\n"
+        "  --sizes LIST     resolutions N (default: 32,128,512,2048); 2D: N substructures,\n"
+        "                   sphere: N substructures and N/2 layers, torus: N main and N/2 pipe segments,\n"
+        "                   cube: N/16 segments per edge\n"
+        "  --repeat N       timed runs per combination after one warm-up run (default: 5)\n"
+        "  --threads N      1 generates on the calling thread, 0 uses all cores (default: 1)\n"
+        "  --weld           include the welding pass\n"
+        "  --out FILE       write the JSON to FILE instead of stdout\n"
+        "  --help           show this message\n";
+}
+
+BenchOptions parseOptions(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (arg == "--weld") {
+            options.weld = true;
+            continue;
+        }
+        if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+        std::string value = argv[++i];
+
+        if (arg == "--shape") options.shapes = parseShapes(value);
+        else if (arg == "--beautify") options.beautify = parseList<int>(arg, value);
+        else if (arg == "--sizes") options.sizes = parseList<int>(arg, value);
+        else if (arg == "--repeat") options.repeat = std::max(1, parseList<int>(arg, value).front());
+        else if (arg == "--threads") options.threads = static_cast<unsigned int>(parseList<int>(arg, value).front());
+        else if (arg == "--out") options.outputPath = value;
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+    return options;
+}
+
+Parameters makeParameters(ShapeType shape, bool beautify, int size, bool weld) {
+    Parameters params;
+    params.shape = shape;
+    params.beautify = beautify;
+    params.weld_vertices = weld;
+    switch (shape) {
+    case ShapeType::TOPOLOGY_2D:
+        params.topology_sides = std::max(3, size);
+        break;
+    case ShapeType::SPHERE:
+        params.sphere_sectors = std::max(3, size);
+        params.sphere_layers = std::max(2, size / 2);
+        break;
+    case ShapeType::TORUS:
+        params.torus_main_segments = std::max(4, size);
+        params.torus_tube_segments = std::max(3, size / 2);
+        break;
+    case ShapeType::CUBE:
+        // 格点数是分段数的三次方，N/16 段和其他形状在同一个 N 下的规模相近
+        params.cube_segments = std::max(1, size / 16);
+        break;
+    default:
+        break;
+    }
+    return params;
+}
+
+const char* shapeName(ShapeType shape) {
+    switch (shape) {
+    case ShapeType::TOPOLOGY_2D: return "2d";
+    case ShapeType::SPHERE: return "sphere";
+    case ShapeType::TORUS: return "torus";
+    case ShapeType::CUBE: return "cube";
+    default: return "unknown";
+    }
+}
+
+// 每次都用新的 TopologyGraph，测的是完整生成而不是增量更新
+BenchResult runBenchmark(const Parameters& params, int size, int repeat, ThreadPool* pool) {
+    BenchResult result;
+    result.params = params;
+    result.size = size;
+
+    // 预热一次，排除首次触碰内存和线程池启动的开销
+    {
+        TopologyGraph graph;
+        graph.setThreadPool(pool);
+        graph.generate(params);
+        result.vertexCount = graph.getVertexCount();
+        result.edgeCount = graph.getIndexCount() / 2;
+    }
+
+    // 预先分配，计时数组本身不计入生成的分配次数
+    std::vector<double> seconds;
+    seconds.reserve(repeat);
+    for (int run = 0; run < repeat; ++run) {
+        TopologyGraph graph;
+        graph.setThreadPool(pool);
+
+        size_t live_before = g_liveBytes.load();
+        size_t count_before = g_allocationCount.load();
+        size_t bytes_before = g_allocatedBytes.load();
+        g_peakBytes.store(live_before);
+
+        auto start = std::chrono::steady_clock::now();
+        graph.generate(params);
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        // 各次生成的分配情况相同，保留最后一次
+        result.allocations = g_allocationCount.load() - count_before;
+        result.allocatedBytes = g_allocatedBytes.load() - bytes_before;
+        result.peakBytes = g_peakBytes.load() - live_before;
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+    result.minSeconds = seconds.front();
+    result.medianSeconds = seconds[seconds.size() / 2];
+    return result;
+}
+
+// 进程的常驻内存峰值（KB），不支持的平台返回 -1
+long long peakResidentKilobytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+    return static_cast<long long>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<long long>(usage.ru_maxrss);
+#endif
+#else
+    return -1;
+#endif
+}
+
+std::string compilerName() {
+    char name[64];
+#if defined(__clang__)
+    std::snprintf(name, sizeof(name), "clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+    std::snprintf(name, sizeof(name), "gcc %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+    std::snprintf(name, sizeof(name), "msvc %d", _MSC_VER);
+#else
+    std::snprintf(name, sizeof(name), "unknown");
+#endif
+    return name;
+}
+
+void writeJson(std::ostream& out, const BenchOptions& options, unsigned int threadCount, const std::vector<BenchResult>& results) {
+    char line[768];
+    out << "{\n";
+    out << "  \"benchmark\": \"TopologyGraph::generate\",\n";
+    out << "  \"compiler\": \"" << compilerName() << "\",\n";
+#ifdef NDEBUG
+    out << "  \"build\": \"release\",\n";
+#else
+    out << "  \"build\": \"debug\",\n";
+#endif
+    out << "  \"threads\": " << threadCount << ",\n";
+    out << "  \"repeat\": " << options.repeat << ",\n";
+    out << "  \"weld\": " << (options.weld ? "true" : "false") << ",\n";
+    out << "  \"peak_rss_kb\": " << peakResidentKilobytes() << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        // 吞吐量按中位数计算，最短耗时单独列出
+        double seconds = std::max(r.medianSeconds, 1e-12);
+        double elements = static_cast<double>(r.vertexCount + r.edgeCount);
+        std::snprintf(line, sizeof(line),
+            "    {\"shape\": \"%s\", \"beautify\": %s, \"size\": %d, \"vertices\": %zu, \"edges\": %zu, "
+            "\"seconds_min\": %.9f, \"seconds_median\": %.9f, \"vertices_per_second\": %.1f, \"edges_per_second\": %.1f, "
+            "\"ns_per_element\": %.3f, \"allocations\": %zu, \"allocated_bytes\": %zu, \"peak_bytes\": %zu}%s\n",
+            shapeName(r.params.shape), r.params.beautify ? "true" : "false", r.size, r.vertexCount, r.edgeCount,
+            r.minSeconds, r.medianSeconds, r.vertexCount / seconds, r.edgeCount / seconds,
+            elements > 0.0 ? seconds * 1e9 / elements : 0.0, r.allocations, r.allocatedBytes, r.peakBytes,
+            i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage();
+        return 1;
+    }
+
+    // 单线程时不使用线程池，生成代码走串行路径
+    std::unique_ptr<ThreadPool> pool;
+    if (options.threads != 1) pool = std::make_unique<ThreadPool>(options.threads);
+    unsigned int thread_count = pool ? pool->getThreadCount() : 1;
+
+    // 进度输出到 stderr，stdout 只留给 JSON
+    std::vector<BenchResult> results;
+    for (ShapeType shape : options.shapes) {
+        for (int beautify : options.beautify) {
+            for (int size : options.sizes) {
+                Parameters params = makeParameters(shape, beautify != 0, size, options.weld);
+                BenchResult result = runBenchmark(params, size, options.repeat, pool.get());
+                std::cerr << shapeName(shape) << " beautify=" << beautify << " size=" << size << ": "
+                    << result.vertexCount << " vertices, " << result.edgeCount << " edges, "
+                    << result.medianSeconds * 1e3 << " ms" << std::endl;
+                results.push_back(result);
+            }
+        }
+    }
+
+    if (options.outputPath.empty()) {
+        writeJson(std::cout, options, thread_count, results);
+        return 0;
+    }
+    std::ofstream file(options.outputPath);
+    if (!file) {
+        std::cerr << "Error: cannot open " << options.outputPath << std::endl;
+        return 1;
+    }
+    writeJson(file, options, thread_count, results);
+    return file ? 0 : 1;
+}
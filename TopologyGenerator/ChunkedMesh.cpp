@@ -0,0 +1,308 @@
+#include "ChunkedMesh.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+// 骞惰#include "ChunkedMesh.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+// 并行时每块至少处理的元素数
+const size_t kMinParallelItems = 16384;
+// 每个方向最多切成的块数
+const int kMaxChunksPerAxis = 64;
+// 聚类格子坐标每个方向占用的位数，三个方向拼成一个 64 位键
+const int kCellBits = 21;
+const uint64_t kEmptyKey = ~0ull;
+// 估计典型边长时抽样的边数
+const size_t kEdgeLengthSamples = 65536;
+
+// 没有线程池或工作量太小时直接在当前线程执行
+void forRange(ThreadPool* pool, size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    if (!pool || count <= minChunk) {
+        body(0, count);
+        return;
+    }
+    pool->parallelFor(0, count, minChunk, body);
+}
+
+uint64_t mixHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+// 键为 64 位整数的开放寻址哈希表，线性探测，只支持插入
+class FlatMap {
+public:
+    explicit FlatMap(size_t count) {
+        size_t size = 16;
+        while (size < count + count / 2) size <<= 1;
+        m_keys.assign(size, kEmptyKey);
+        m_values.resize(size);
+        m_mask = size - 1;
+    }
+
+    // 键不存在时插入 value，返回表中这个键对应的值
+    uint32_t insert(uint64_t key, uint32_t value) {
+        size_t slot = mixHash(key) & m_mask;
+        while (m_keys[slot] != kEmptyKey) {
+            if (m_keys[slot] == key) return m_values[slot];
+            slot = (slot + 1) & m_mask;
+        }
+        m_keys[slot] = key;
+        m_values[slot] = value;
+        return value;
+    }
+
+    // 键不存在时插入并返回 true
+    bool insertUnique(uint64_t key) {
+        size_t slot = mixHash(key) & m_mask;
+        while (m_keys[slot] != kEmptyKey) {
+            if (m_keys[slot] == key) return false;
+            slot = (slot + 1) & m_mask;
+        }
+        m_keys[slot] = key;
+        return true;
+    }
+
+private:
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_values;
+    size_t m_mask = 0;
+};
+
+}
+
+void ChunkedMesh::clear() {
+    m_chunks.clear();
+    m_indices.clear();
+    m_lodCount = 0;
+    m_cellSize = 0.0f;
+}
+
+void ChunkedMesh::build(const TopologyGraph& graph, ThreadPool* pool, size_t targetEdgesPerChunk, int lodCount) {
+    clear();
+    ArrayView<glm::vec3> vertices = graph.getVertices();
+    ArrayView<unsigned int> indices = graph.getIndices();
+    const size_t vertex_count = vertices.size();
+    const size_t edge_count = indices.size() / 2;
+    if (vertex_count == 0) return;
+    m_lodCount = std::max(1, lodCount);
+
+    // 包围盒
+    glm::vec3 lower(vertices[0]), upper(vertices[0]);
+    std::mutex mutex;
+    forRange(pool, vertex_count, kMinParallelItems, [&](size_t begin, size_t end) {
+        glm::vec3 local_lower(vertices[begin]), local_upper(vertices[begin]);
+        for (size_t v = begin; v < end; ++v) {
+            local_lower = glm::min(local_lower, vertices[v]);
+            local_upper = glm::max(local_upper, vertices[v]);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        lower = glm::min(lower, local_lower);
+        upper = glm::max(upper, local_upper);
+    });
+
+    // 典型边长取等间隔抽样的中位数，少量很长的边（例如美化结构的径向线）不会把格子拉大
+    std::vector<float> lengths;
+    size_t sample_step = std::max<size_t>(1, edge_count / kEdgeLengthSamples);
+    for (size_t e = 0; e < edge_count; e += sample_step) {
+        float length = glm::length(vertices[indices[e * 2]] - vertices[indices[e * 2 + 1]]);
+        if (length > 0.0f) lengths.push_back(length);
+    }
+
+    const glm::vec3 extent = upper - lower;
+    const float max_extent = std::max(extent.x, std::max(extent.y, extent.z));
+    if (!lengths.empty()) {
+        std::nth_element(lengths.begin(), lengths.begin() + lengths.size() / 2, lengths.end());
+        m_cellSize = lengths[lengths.size() / 2];
+    }
+    else {
+        m_cellSize = max_extent / std::cbrt(static_cast<float>(vertex_count));
+    }
+    // 聚类格子坐标要放得进 kCellBits 位
+    m_cellSize = std::max(m_cellSize, std::max(max_extent, 1e-6f) / static_cast<float>(1 << (kCellBits - 1)));
+
+    // 按体积把包围盒切成大约 chunk_target 块，厚度可以忽略的方向（例如 2D 拓扑图的 z 方向）不切
+    size_t chunk_target = std::max<size_t>(1, (std::max(edge_count, vertex_count) + targetEdgesPerChunk - 1) / targetEdgesPerChunk);
+    double volume = 1.0;
+    int active_axes = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (extent[k] > max_extent * 1e-3f) {
+            volume *= extent[k];
+            ++active_axes;
+        }
+    }
+    int dims[3] = { 1, 1, 1 };
+    if (active_axes > 0) {
+        double side = std::pow(volume / static_cast<double>(chunk_target), 1.0 / active_axes);
+        for (int k = 0; k < 3; ++k) {
+            if (extent[k] > max_extent * 1e-3f) {
+                dims[k] = std::min(kMaxChunksPerAxis, std::max(1, static_cast<int>(std::ceil(extent[k] / side))));
+            }
+        }
+    }
+    const size_t chunk_count = static_cast<size_t>(dims[0]) * dims[1] * dims[2];
+    auto chunkOf = [&](const glm::vec3& p) {
+        int cell[3];
+        for (int k = 0; k < 3; ++k) {
+            cell[k] = extent[k] > 0.0f ? static_cast<int>((p[k] - lower[k]) / extent[k] * dims[k]) : 0;
+            cell[k] = std::min(std::max(cell[k], 0), dims[k] - 1);
+        }
+        return static_cast<unsigned int>((cell[2] * dims[1] + cell[1]) * dims[0] + cell[0]);
+    };
+
+    // 边按中点归块，点按自身位置归块，再用计数排序按块分组，块内保持原来的顺序
+    std::vector<unsigned int> edge_chunk(edge_count), vertex_chunk(vertex_count);
+    forRange(pool, edge_count, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            edge_chunk[e] = chunkOf(0.5f * (vertices[indices[e * 2]] + vertices[indices[e * 2 + 1]]));
+        }
+    });
+    forRange(pool, vertex_count, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) vertex_chunk[v] = chunkOf(vertices[v]);
+    });
+
+    std::vector<size_t> edge_start(chunk_count + 1, 0), vertex_start(chunk_count + 1, 0);
+    for (unsigned int c : edge_chunk) ++edge_start[c + 1];
+    for (unsigned int c : vertex_chunk) ++vertex_start[c + 1];
+    for (size_t c = 0; c < chunk_count; ++c) {
+        edge_start[c + 1] += edge_start[c];
+        vertex_start[c + 1] += vertex_start[c];
+    }
+    std::vector<unsigned int> edge_order(edge_count), vertex_order(vertex_count);
+    {
+        std::vector<size_t> cursor(edge_start.begin(), edge_start.end() - 1);
+        for (size_t e = 0; e < edge_count; ++e) edge_order[cursor[edge_chunk[e]]++] = static_cast<unsigned int>(e);
+        cursor.assign(vertex_start.begin(), vertex_start.end() - 1);
+        for (size_t v = 0; v < vertex_count; ++v) vertex_order[cursor[vertex_chunk[v]]++] = static_cast<unsigned int>(v);
+    }
+    std::vector<unsigned int>().swap(edge_chunk);
+    std::vector<unsigned int>().swap(vertex_chunk);
+
+    m_chunks.resize(chunk_count);
+    for (MeshChunk& chunk : m_chunks) {
+        chunk.edgeOffsets.assign(m_lodCount, 0);
+        chunk.edgeCounts.assign(m_lodCount, 0);
+        chunk.pointOffsets.assign(m_lodCount, 0);
+        chunk.pointCounts.assign(m_lodCount, 0);
+    }
+
+    // 0 级：原始的边和点按块重新排列，直接写到最终位置
+    m_indices.resize(edge_count * 2 + vertex_count);
+    forRange(pool, chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            MeshChunk& chunk = m_chunks[c];
+            chunk.boundsMin = glm::vec3(INFINITY);
+            chunk.boundsMax = glm::vec3(-INFINITY);
+            chunk.edgeOffsets[0] = edge_start[c] * 2;
+            chunk.edgeCounts[0] = (edge_start[c + 1] - edge_start[c]) * 2;
+            for (size_t k = edge_start[c]; k < edge_start[c + 1]; ++k) {
+                for (int end_point = 0; end_point < 2; ++end_point) {
+                    unsigned int v = indices[edge_order[k] * 2 + end_point];
+                    m_indices[k * 2 + end_point] = v;
+                    chunk.boundsMin = glm::min(chunk.boundsMin, vertices[v]);
+                    chunk.boundsMax = glm::max(chunk.boundsMax, vertices[v]);
+                }
+            }
+            chunk.pointOffsets[0] = edge_count * 2 + vertex_start[c];
+            chunk.pointCounts[0] = vertex_start[c + 1] - vertex_start[c];
+            for (size_t k = vertex_start[c]; k < vertex_start[c + 1]; ++k) {
+                unsigned int v = vertex_order[k];
+                m_indices[edge_count * 2 + k] = v;
+                chunk.boundsMin = glm::min(chunk.boundsMin, vertices[v]);
+                chunk.boundsMax = glm::max(chunk.boundsMax, vertices[v]);
+            }
+        }
+    });
+
+    // 更粗的级别：level 级的格子由 level - 1 级相邻的 2x2x2 个格子合并而成，
+    // 所以只需要在上一级的代表顶点中按编号从小到大再选一次代表
+    const float inv_cell = 1.0f / (m_cellSize * 2.0f);
+    auto cellKey = [&](const glm::vec3& p, int shift) {
+        glm::vec3 q = (p - lower) * inv_cell;
+        uint64_t key = 0;
+        for (int k = 0; k < 3; ++k) {
+            uint64_t cell = static_cast<uint64_t>(std::max(0.0f, q[k])) >> shift;
+            key |= std::min<uint64_t>(cell, (1ull << kCellBits) - 1) << (k * kCellBits);
+        }
+        return key;
+    };
+
+    std::vector<unsigned int> rep(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) rep[v] = static_cast<unsigned int>(v);
+    size_t rep_count = vertex_count;
+    for (int level = 1; level < m_lodCount; ++level) {
+        // 上一级的代表顶点按编号顺序插入，每个格子保留第一个（编号最小的）
+        FlatMap clusters(rep_count);
+        rep_count = 0;
+        for (size_t v = 0; v < vertex_count; ++v) {
+            if (rep[v] != v) continue;
+            unsigned int chosen = clusters.insert(cellKey(vertices[v], level - 1), static_cast<unsigned int>(v));
+            rep[v] = chosen;
+            if (chosen == v) ++rep_count;
+        }
+        // 其余顶点跟随原来的代表；上一级代表顶点的新代表在上面已经写好，这里不会再被修改
+        forRange(pool, vertex_count, kMinParallelItems, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                unsigned int next = rep[rep[v]];
+                if (next != rep[v]) rep[v] = next;
+            }
+        });
+
+        std::vector<std::vector<unsigned int>> level_edges(chunk_count), level_points(chunk_count);
+        forRange(pool, chunk_count, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                MeshChunk& chunk = m_chunks[c];
+                std::vector<unsigned int>& out_edges = level_edges[c];
+                FlatMap seen(edge_start[c + 1] - edge_start[c]);
+                for (size_t k = edge_start[c]; k < edge_start[c + 1]; ++k) {
+                    unsigned int a = rep[indices[edge_order[k] * 2]];
+                    unsigned int b = rep[indices[edge_order[k] * 2 + 1]];
+                    if (a == b) continue;
+                    if (!seen.insertUnique((static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b))) continue;
+                    out_edges.push_back(a);
+                    out_edges.push_back(b);
+                    // 代表顶点可能落在相邻块里，包围盒要把它们也包进来
+                    chunk.boundsMin = glm::min(chunk.boundsMin, glm::min(vertices[a], vertices[b]));
+                    chunk.boundsMax = glm::max(chunk.boundsMax, glm::max(vertices[a], vertices[b]));
+                }
+                for (size_t k = vertex_start[c]; k < vertex_start[c + 1]; ++k) {
+                    unsigned int v = vertex_order[k];
+                    if (rep[v] == v) level_points[c].push_back(v);
+                }
+            }
+        });
+
+        for (size_t c = 0; c < chunk_count; ++c) {
+            MeshChunk& chunk = m_chunks[c];
+            chunk.edgeOffsets[level] = m_indices.size();
+            chunk.edgeCounts[level] = level_edges[c].size();
+            m_indices.insert(m_indices.end(), level_edges[c].begin(), level_edges[c].end());
+            chunk.pointOffsets[level] = m_indices.size();
+            chunk.pointCounts[level] = level_points[c].size();
+            m_indices.insert(m_indices.end(), level_points[c].begin(), level_points[c].end());
+        }
+    }
+
+    // 去掉空块，渲染时少遍历一些
+    m_chunks.erase(std::remove_if(m_chunks.begin(), m_chunks.end(), [](const MeshChunk& chunk) {
+        return chunk.edgeCounts[0] == 0 && chunk.pointCounts[0] == 0;
+    }), m_chunks.end());
+}
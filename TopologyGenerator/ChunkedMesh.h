@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 鍒嗗潡鐨勪竴涓#pragma once
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 分块的一个区域：包围盒和每一级 LOD 的边、点在合并索引数组中的范围
+struct MeshChunk {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    // 下标为 LOD 级别，0 级为原始数据
+    std::vector<size_t> edgeOffsets, edgeCounts;
+    std::vector<size_t> pointOffsets, pointCounts;
+};
+
+// 大规模模式使用的分块网格：按空间网格把图形切成若干块，每块带包围盒，供渲染时做视锥剔除
+// 每块额外生成若干级更粗的 LOD：按 2^level 倍典型边长（边长的中位数）的格子聚类顶点，每个格子只保留编号最小的顶点，
+// 边的两端换成所在格子的代表顶点，去掉退化边和重复边
+// 所有级别都只是索引，引用原图形的顶点数组，不复制顶点；同一级别的代表顶点在全图范围内选出，相邻块之间不会出现裂缝
+class ChunkedMesh {
+public:
+    // targetEdgesPerChunk 为每块的目标边数，lodCount 包括 0 级在内的级数
+    void build(const TopologyGraph& graph, ThreadPool* pool = nullptr, size_t targetEdgesPerChunk = 65536, int lodCount = 4);
+    void clear();
+
+    const std::vector<MeshChunk>& getChunks() const { return m_chunks; }
+    // 所有块、所有级别的边索引和点索引依次排列
+    const std::vector<unsigned int>& getIndices() const { return m_indices; }
+    int getLodCount() const { return m_lodCount; }
+    // 第 level 级聚类格子的边长，0 级为典型边长
+    float getLodCellSize(int level) const { return m_cellSize * static_cast<float>(1 << level); }
+
+private:
+    std::vector<MeshChunk> m_chunks;
+    std::vector<unsigned int> m_indices;
+    int m_lodCount = 0;
+    float m_cellSize = 0.0f;
+};
@@ -0,0 +1,225 @@
+#pragma once
+// 鍛戒护琛屽伐鍏凤紙TopologyBatch銆乀opologyBench銆乀opologyRender锛夊叡鐢ㄧ殑鍙傛暟瑙ｆ瀽
+#include "TopologyGraph.h"
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdio>
+
+// 鍛戒护琛岄噷鐨勫彇鍊煎垪琛#pragma once
+// 命令行工具（TopologyBatch、TopologyBench、TopologyRender）共用的参数解析
+#include "TopologyGraph.h"
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdio>
+
+// 命令行里的取值列表，例如 "3,5,8" 或 "4:100:8"（起点:终点:步长，包含终点）
+template <typename T>
+std::vector<T> parseList(const std::string& option, const std::string& text) {
+    std::vector<T> values;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = (comma == std::string::npos) ? text.size() + 1 : comma + 1;
+        if (item.empty()) continue;
+
+        // 拆分区间写法
+        std::vector<double> parts;
+        size_t partStart = 0;
+        while (partStart <= item.size()) {
+            size_t colon = item.find(':', partStart);
+            std::string part = item.substr(partStart, colon == std::string::npos ? std::string::npos : colon - partStart);
+            partStart = (colon == std::string::npos) ? item.size() + 1 : colon + 1;
+            char* parseEnd = nullptr;
+            double value = std::strtod(part.c_str(), &parseEnd);
+            if (part.empty() || *parseEnd != '\0') {
+                throw std::invalid_argument("invalid value '" + part + "' for " + option);
+            }
+            parts.push_back(value);
+        }
+
+        if (parts.size() == 1) {
+            values.push_back(static_cast<T>(parts[0]));
+        }
+        else if (parts.size() == 2 || parts.size() == 3) {
+            double step = parts.size() == 3 ? parts[2] : 1.0;
+            if (step <= 0.0) throw std::invalid_argument("step must be positive for " + option);
+            // 加一点余量，避免浮点累加误差丢掉终点
+            for (double v = parts[0]; v <= parts[1] + step * 1e-6; v += step) {
+                values.push_back(static_cast<T>(v));
+            }
+        }
+        else {
+            throw std::invalid_argument("invalid range '" + item + "' for " + option);
+        }
+    }
+    if (values.empty()) throw std::invalid_argument("empty list for " + option);
+    return values;
+}
+
+inline std::vector<ShapeType> parseShapes(const std::string& text) {
+    std::vector<ShapeType> shapes;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string name = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = (comma == std::string::npos) ? text.size() + 1 : comma + 1;
+        if (name.empty()) continue;
+        if (name == "2d") shapes.push_back(ShapeType::TOPOLOGY_2D);
+        else if (name == "sphere") shapes.push_back(ShapeType::SPHERE);
+        else if (name == "torus") shapes.push_back(ShapeType::TORUS);
+        else if (name == "cube") shapes.push_back(ShapeType::CUBE);
+        else throw std::invalid_argument("unknown shape '" + name + "'");
+    }
+    if (shapes.empty()) throw std::invalid_argument("empty list for --shape");
+    return shapes;
+}
+
+// 参数扫描，未指定的字段沿用 Parameters 的默认值
+struct ParameterSweep {
+    std::vector<ShapeType> shapes{ ShapeType::TOPOLOGY_2D, ShapeType::SPHERE, ShapeType::TORUS };
+    std::vector<int> beautify{ 0 };
+    std::vector<int> sides{ Parameters().topology_sides };
+    std::vector<int> topologyPoints{ Parameters().topology_points_per_sector };
+    std::vector<int> sectors{ Parameters().sphere_sectors };
+    std::vector<int> spherePoints{ Parameters().sphere_points_per_sector };
+    std::vector<int> layers{ Parameters().sphere_layers };
+    std::vector<int> mainSegments{ Parameters().torus_main_segments };
+    std::vector<int> tubeSegments{ Parameters().torus_tube_segments };
+    std::vector<float> mainRadius{ Parameters().torus_main_radius };
+    std::vector<float> tubeRadius{ Parameters().torus_tube_radius };
+    std::vector<int> cubeSegments{ Parameters().cube_segments };
+    std::vector<float> cubeSize{ Parameters().cube_size };
+};
+
+// 扫描参数的帮助信息
+constexpr const char* kSweepUsage =
+    "A LIST is comma separated values or inclusive ranges start:end[:step], e.g. 3,5,8 or 4:100:8\n"
+    "\n"
+    "  --shape LIST          2d, sphere, torus, cube (default: 2d,sphere,torus)\n"
+    "  --beautify LIST       0 and/or 1 (default: 0)\n"
+    "  --sides LIST          2D topology: number of substructures\n"
+    "  --topology-points LIST  2D topology: points per substructure (beautify only)\n"
+    "  --sectors LIST        sphere: number of substructures\n"
+    "  --sphere-points LIST  sphere: points per substructure (beautify only)\n"
+    "  --layers LIST         sphere: height layers\n"
+    "  --main-segments LIST  torus: main ring segments\n"
+    "  --tube-segments LIST  torus: pipe ring segments\n"
+    "  --main-radius LIST    torus: main ring radius\n"
+    "  --tube-radius LIST    torus: pipe ring radius\n"
+    "  --cube-segments LIST  cube: segments per edge\n"
+    "  --cube-size LIST      cube: edge length\n";
+
+// arg 是扫描参数时解析 value 并返回 true
+inline bool parseSweepOption(const std::string& arg, const std::string& value, ParameterSweep& sweep) {
+    if (arg == "--shape") sweep.shapes = parseShapes(value);
+    else if (arg == "--beautify") sweep.beautify = parseList<int>(arg, value);
+    else if (arg == "--sides") sweep.sides = parseList<int>(arg, value);
+    else if (arg == "--topology-points") sweep.topologyPoints = parseList<int>(arg, value);
+    else if (arg == "--sectors") sweep.sectors = parseList<int>(arg, value);
+    else if (arg == "--sphere-points") sweep.spherePoints = parseList<int>(arg, value);
+    else if (arg == "--layers") sweep.layers = parseList<int>(arg, value);
+    else if (arg == "--main-segments") sweep.mainSegments = parseList<int>(arg, value);
+    else if (arg == "--tube-segments") sweep.tubeSegments = parseList<int>(arg, value);
+    else if (arg == "--main-radius") sweep.mainRadius = parseList<float>(arg, value);
+    else if (arg == "--tube-radius") sweep.tubeRadius = parseList<float>(arg, value);
+    else if (arg == "--cube-segments") sweep.cubeSegments = parseList<int>(arg, value);
+    else if (arg == "--cube-size") sweep.cubeSize = parseList<float>(arg, value);
+    else return false;
+    return true;
+}
+
+// 展开成所有参数组合，只对当前形状真正用到的字段做笛卡尔积，避免生成重复网格
+inline std::vector<Parameters> expandSweep(const ParameterSweep& sweep, bool weld) {
+    std::vector<Parameters> jobs;
+    for (ShapeType shape : sweep.shapes) {
+        for (int beautify : sweep.beautify) {
+            Parameters base;
+            base.shape = shape;
+            base.beautify = beautify != 0;
+            base.weld_vertices = weld;
+
+            switch (shape) {
+            case ShapeType::TOPOLOGY_2D: {
+                // 每个子结构的点数只在美化模式下起作用
+                std::vector<int> points = base.beautify ? sweep.topologyPoints : std::vector<int>{ base.topology_points_per_sector };
+                for (int sides : sweep.sides)
+                    for (int p : points) {
+                        Parameters params = base;
+                        params.topology_sides = sides;
+                        params.topology_points_per_sector = p;
+                        jobs.push_back(params);
+                    }
+                break;
+            }
+            case ShapeType::SPHERE: {
+                std::vector<int> points = base.beautify ? sweep.spherePoints : std::vector<int>{ base.sphere_points_per_sector };
+                for (int sectors : sweep.sectors)
+                    for (int layers : sweep.layers)
+                        for (int p : points) {
+                            Parameters params = base;
+                            params.sphere_sectors = sectors;
+                            params.sphere_layers = layers;
+                            params.sphere_points_per_sector = p;
+                            jobs.push_back(params);
+                        }
+                break;
+            }
+            case ShapeType::TORUS:
+                for (int mainSegments : sweep.mainSegments)
+                    for (int tubeSegments : sweep.tubeSegments)
+                        for (float mainRadius : sweep.mainRadius)
+                            for (float tubeRadius : sweep.tubeRadius) {
+                                Parameters params = base;
+                                params.torus_main_segments = mainSegments;
+                                params.torus_tube_segments = tubeSegments;
+                                params.torus_main_radius = mainRadius;
+                                params.torus_tube_radius = tubeRadius;
+                                jobs.push_back(params);
+                            }
+                break;
+            case ShapeType::CUBE:
+                for (int segments : sweep.cubeSegments)
+                    for (float size : sweep.cubeSize) {
+                        Parameters params = base;
+                        params.cube_segments = segments;
+                        params.cube_size = size;
+                        jobs.push_back(params);
+                    }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return jobs;
+}
+
+// 根据参数生成唯一的文件名（不含扩展名）
+inline std::string makeFileName(const Parameters& params) {
+    char name[160];
+    switch (params.shape) {
+    case ShapeType::TOPOLOGY_2D:
+        std::snprintf(name, sizeof(name), "2d_n%d_p%d_b%d",
+            params.topology_sides, params.topology_points_per_sector, params.beautify ? 1 : 0);
+        break;
+    case ShapeType::SPHERE:
+        std::snprintf(name, sizeof(name), "sphere_s%d_l%d_p%d_b%d",
+            params.sphere_sectors, params.sphere_layers, params.sphere_points_per_sector, params.beautify ? 1 : 0);
+        break;
+    case ShapeType::CUBE:
+        std::snprintf(name, sizeof(name), "cube_n%d_a%.3f_b%d",
+            params.cube_segments, params.cube_size, params.beautify ? 1 : 0);
+        break;
+    default:
+        std::snprintf(name, sizeof(name), "torus_m%d_t%d_R%.3f_r%.3f_b%d",
+            params.torus_main_segments, params.torus_tube_segments,
+            params.torus_main_radius, params.torus_tube_radius, params.beautify ? 1 : 0);
+        break;
+    }
+    return name;
+}
@@ -0,0 +1,217 @@
+#include "FrameProfiler.h"
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// 浜嬩欢澶勭悊鍜屼氦鎹㈢紦鍐插尯涓嶆彁浜#include "FrameProfiler.h"
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// 事件处理和交换缓冲区不提交 GL 命令，不计 GPU 耗时
+bool hasGpuWork(int phase) {
+    return phase != static_cast<int>(FramePhase::EVENTS) && phase != static_cast<int>(FramePhase::SWAP);
+}
+
+}
+
+void FrameProfiler::init() {
+    m_queries.resize(kQueryFrames * kPhaseCount);
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void FrameProfiler::destroy() {
+    if (m_queries.empty()) return;
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+    m_queries.clear();
+}
+
+double FrameProfiler::elapsedMicroseconds(Clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - m_origin).count();
+}
+
+void FrameProfiler::beginFrame() {
+    Clock::time_point now = Clock::now();
+    if (m_frameCount == 0) m_origin = now;
+    m_frameStart = now;
+
+    // 这个槽位上一次使用是 kQueryFrames 帧之前，先取回结果再复用
+    int slot = static_cast<int>(m_frameCount % kQueryFrames);
+    collectQueries(slot);
+    m_queryFrame[slot] = m_frameCount;
+
+    FrameRecord& record = currentFrame();
+    record = FrameRecord();
+    record.frame = m_frameCount;
+    record.start = elapsedMicroseconds(now);
+}
+
+void FrameProfiler::endFrame() {
+    currentFrame().duration = std::chrono::duration<double, std::micro>(Clock::now() - m_frameStart).count();
+    ++m_frameCount;
+}
+
+void FrameProfiler::beginPhase(FramePhase phase) {
+    int index = static_cast<int>(phase);
+    if (!m_queries.empty() && hasGpuWork(index)) {
+        int slot = static_cast<int>(m_frameCount % kQueryFrames);
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[slot * kPhaseCount + index]);
+        m_queryIssued[slot][index] = true;
+    }
+    m_phaseStart = Clock::now();
+}
+
+void FrameProfiler::endPhase(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    int index = static_cast<int>(phase);
+    int slot = static_cast<int>(m_frameCount % kQueryFrames);
+    if (m_queryIssued[slot][index]) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    PhaseSample& sample = currentFrame().phases[index];
+    sample.cpuStart = elapsedMicroseconds(m_phaseStart);
+    sample.cpuDuration = std::chrono::duration<double, std::micro>(now - m_phaseStart).count();
+}
+
+void FrameProfiler::collectQueries(int slot) {
+    uint64_t frame = m_queryFrame[slot];
+    // 对应的帧已经被新记录覆盖时只清除标记
+    bool in_history = m_frameCount - frame < kHistoryFrames;
+    for (int phase = 0; phase < kPhaseCount; ++phase) {
+        if (!m_queryIssued[slot][phase]) continue;
+        m_queryIssued[slot][phase] = false;
+
+        GLuint query = m_queries[slot * kPhaseCount + phase];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available || !in_history) continue;
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        m_history[frame % kHistoryFrames].phases[phase].gpuDuration = nanoseconds / 1000.0;
+    }
+}
+
+const char* FrameProfiler::getPhaseName(FramePhase phase) {
+    switch (phase) {
+    case FramePhase::EVENTS: return "events";
+    case FramePhase::UI: return "ui";
+    case FramePhase::GENERATE: return "generate";
+    case FramePhase::UPLOAD: return "upload";
+    case FramePhase::SCENE: return "scene";
+    case FramePhase::IMGUI_DRAW: return "imgui draw";
+    case FramePhase::SCREENSHOT: return "screenshot";
+    case FramePhase::SWAP: return "swap";
+    default: return "unknown";
+    }
+}
+
+size_t FrameProfiler::getCompletedFrames() const {
+    // 正在记录的帧占用了最旧一帧的位置
+    return static_cast<size_t>(std::min<uint64_t>(m_frameCount, kHistoryFrames - 1));
+}
+
+double FrameProfiler::percentile(FramePhase phase, double percentile, bool gpu) const {
+    int index = static_cast<int>(phase);
+    std::vector<double> values;
+    size_t frames = getCompletedFrames();
+    values.reserve(frames);
+    for (size_t i = 1; i <= frames; ++i) {
+        const PhaseSample& sample = m_history[(m_frameCount - i) % kHistoryFrames].phases[index];
+        if (sample.cpuStart < 0.0) continue;
+        if (gpu) {
+            if (sample.gpuDuration >= 0.0) values.push_back(sample.gpuDuration);
+        }
+        else {
+            values.push_back(sample.cpuDuration);
+        }
+    }
+    if (values.empty()) return 0.0;
+
+    size_t rank = static_cast<size_t>(percentile * (values.size() - 1) + 0.5);
+    rank = std::min(rank, values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank] / 1000.0;
+}
+
+double FrameProfiler::getCpuPercentile(FramePhase phase, double percentile) const {
+    return this->percentile(phase, percentile, false);
+}
+
+double FrameProfiler::getGpuPercentile(FramePhase phase, double percentile) const {
+    return this->percentile(phase, percentile, true);
+}
+
+std::vector<float> FrameProfiler::getFrameTimes() const {
+    size_t frames = getCompletedFrames();
+    std::vector<float> times(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        times[i] = static_cast<float>(m_history[(m_frameCount - frames + i) % kHistoryFrames].duration / 1000.0);
+    }
+    return times;
+}
+
+bool FrameProfiler::writeCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    file << "frame,phase,cpu_start_us,cpu_ms,gpu_ms\n";
+    char line[160];
+    size_t frames = getCompletedFrames();
+    for (size_t i = frames; i >= 1; --i) {
+        const FrameRecord& record = m_history[(m_frameCount - i) % kHistoryFrames];
+        for (int phase = 0; phase < kPhaseCount; ++phase) {
+            const PhaseSample& sample = record.phases[phase];
+            if (sample.cpuStart < 0.0) continue;
+            int length = std::snprintf(line, sizeof(line), "%llu,%s,%.1f,%.4f,",
+                static_cast<unsigned long long>(record.frame), getPhaseName(static_cast<FramePhase>(phase)),
+                sample.cpuStart, sample.cpuDuration / 1000.0);
+            // 没有 GPU 结果时留空
+            if (sample.gpuDuration >= 0.0) {
+                std::snprintf(line + length, sizeof(line) - length, "%.4f", sample.gpuDuration / 1000.0);
+            }
+            file << line << '\n';
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    // 完整事件（ph 为 X）的时间单位是微秒，tid 1 为 CPU，tid 2 为 GPU
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}},\n";
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+    char line[256];
+    size_t frames = getCompletedFrames();
+    for (size_t i = frames; i >= 1; --i) {
+        const FrameRecord& record = m_history[(m_frameCount - i) % kHistoryFrames];
+        std::snprintf(line, sizeof(line),
+            ",\n{\"name\": \"frame %llu\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.1f, \"dur\": %.1f}",
+            static_cast<unsigned long long>(record.frame), record.start, record.duration);
+        file << line;
+        for (int phase = 0; phase < kPhaseCount; ++phase) {
+            const PhaseSample& sample = record.phases[phase];
+            if (sample.cpuStart < 0.0) continue;
+            const char* name = getPhaseName(static_cast<FramePhase>(phase));
+            std::snprintf(line, sizeof(line),
+                ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.1f, \"dur\": %.1f}",
+                name, sample.cpuStart, sample.cpuDuration);
+            file << line;
+            if (sample.gpuDuration >= 0.0) {
+                std::snprintf(line, sizeof(line),
+                    ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 2, \"ts\": %.1f, \"dur\": %.1f}",
+                    name, sample.cpuStart, sample.gpuDuration);
+                file << line;
+            }
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
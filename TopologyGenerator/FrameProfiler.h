@@ -0,0 +1,92 @@
+#pragma once
+#include <glad/glad.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// 涓诲惊鐜#pragma once
+#include <glad/glad.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// 主循环中依次执行的各个阶段
+enum class FramePhase { EVENTS, UI, GENERATE, UPLOAD, SCENE, IMGUI_DRAW, SCREENSHOT, SWAP, COUNT };
+
+// 逐帧记录各阶段的 CPU 耗时（steady_clock）和 GPU 耗时（GL_TIME_ELAPSED 查询）
+// 查询对象按帧轮换，kQueryFrames 帧之后结果已经可用时才读取，从不等待 GPU；到时仍不可用的样本直接丢弃
+// 同一时刻只能有一个 GL_TIME_ELAPSED 查询，所以各阶段不能嵌套
+class FrameProfiler {
+public:
+    static constexpr int kPhaseCount = static_cast<int>(FramePhase::COUNT);
+    // 保留最近多少帧，用于统计分位数和导出
+    static constexpr size_t kHistoryFrames = 600;
+    // 查询环的长度（帧）
+    static constexpr int kQueryFrames = 4;
+
+    FrameProfiler() = default;
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // 创建查询对象，需要当前线程有 GL 上下文；不调用时只记录 CPU 耗时
+    void init();
+    // 释放查询对象，必须在 GL 上下文销毁之前调用
+    void destroy();
+
+    void beginFrame();
+    void endFrame();
+    void beginPhase(FramePhase phase);
+    void endPhase(FramePhase phase);
+
+    static const char* getPhaseName(FramePhase phase);
+    // 最近若干帧中该阶段耗时（毫秒）的分位数，percentile 取 0 到 1；这段时间没有执行过该阶段时返回 0
+    double getCpuPercentile(FramePhase phase, double percentile) const;
+    double getGpuPercentile(FramePhase phase, double percentile) const;
+    // 最近若干帧的总 CPU 耗时（毫秒），从旧到新
+    std::vector<float> getFrameTimes() const;
+
+    // 导出最近若干帧：CSV 每行一个阶段；Chrome trace 可以用 chrome://tracing 或 Perfetto 打开，
+    // GPU 阶段画在单独的一行上，起点取 CPU 提交的时刻
+    bool writeCsv(const std::string& path) const;
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // 时间都以微秒为单位，起点为第一次 beginFrame
+    struct PhaseSample {
+        // 小于 0 表示这一帧没有执行该阶段
+        double cpuStart = -1.0;
+        double cpuDuration = 0.0;
+        // 小于 0 表示没有 GPU 结果
+        double gpuDuration = -1.0;
+    };
+    struct FrameRecord {
+        uint64_t frame = 0;
+        double start = 0.0;
+        double duration = 0.0;
+        PhaseSample phases[kPhaseCount];
+    };
+
+    // 已完成的帧数，第 m_frameCount 帧是正在记录的帧
+    uint64_t m_frameCount = 0;
+    std::vector<FrameRecord> m_history = std::vector<FrameRecord>(kHistoryFrames);
+    Clock::time_point m_origin;
+    Clock::time_point m_frameStart;
+    Clock::time_point m_phaseStart;
+
+    // 第 slot 个槽位中第 phase 个阶段的查询为 m_queries[slot * kPhaseCount + phase]
+    std::vector<GLuint> m_queries;
+    uint64_t m_queryFrame[kQueryFrames] = {};
+    bool m_queryIssued[kQueryFrames][kPhaseCount] = {};
+
+    double elapsedMicroseconds(Clock::time_point time) const;
+    FrameRecord& currentFrame() { return m_history[m_frameCount % kHistoryFrames]; }
+    // 读取槽位中已经完成的查询，写回对应帧的记录
+    void collectQueries(int slot);
+    // 已完成且仍保留在历史中的帧数
+    size_t getCompletedFrames() const;
+    double percentile(FramePhase phase, double percentile, bool gpu) const;
+};
@@ -0,0 +1,134 @@
+// AsyncGenerator 鍜屾渶杩戝浘褰㈢紦瀛橀厤鍚堢殑妫€鏌ワ細鎸変富绋嬪簭 fetchGraph 鐨勬柟寮忓彇缁撴灉锛屾嫇鎵戝弬鏁板彉鍖栨椂鎶婃棫鍥惧舰浜ょ粰缂撳瓨锛// AsyncGenerator 和最近图形缓存配合的检查：按主程序 fetchGraph 的方式取结果，拓扑参数变化时把旧图形交给缓存，
+// 确认拖动几何参数（圆环半径、立方体棱长）时后台仍然只更新坐标，并且不会每个值都放进缓存；全部通过时返回 0
+#include "AsyncGenerator.h"
+#include "TopologyGraph.h"
+
+#include <iostream>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <cstddef>
+
+namespace {
+
+// 模拟主程序的渲染线程：m_graph 是正在显示的图形，retired 是 GraphCache（insert 时和缓存中的空图形交换）
+class Viewer {
+public:
+    Viewer() {
+        m_generator.setReadyCallback([this]() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wake = true;
+            m_readyCv.notify_one();
+        });
+    }
+
+    // 提交参数并等结果换入，返回换入时的变化程度
+    GraphChange show(const Parameters& params) {
+        m_generator.request(params);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_readyCv.wait(lock, [this] { return m_wake; });
+            m_wake = false;
+        }
+        GraphChange change = GraphChange::NONE;
+        m_generator.fetch(m_graph, change, [this](TopologyGraph& graph) {
+            if (!graph.hasGenerated()) return;
+            m_retired.emplace_back();
+            std::swap(m_retired.back(), graph);
+        });
+        return change;
+    }
+
+    const TopologyGraph& getGraph() const { return m_graph; }
+    size_t getRetiredCount() const { return m_retired.size(); }
+    AsyncGenerator::Stats getStats() const { return m_generator.getStats(); }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_readyCv;
+    bool m_wake = false;
+
+    TopologyGraph m_graph;
+    std::deque<TopologyGraph> m_retired;
+    // 最后声明，最先析构，工作线程结束后其他成员才销毁
+    AsyncGenerator m_generator;
+};
+
+// 后台结果和单独整体生成的结果逐个比较
+bool sameAsFreshGenerate(const TopologyGraph& graph) {
+    TopologyGraph fresh;
+    fresh.generate(graph.getParameters());
+    if (fresh.getVertexCount() != graph.getVertexCount() || fresh.getIndexCount() != graph.getIndexCount()) return false;
+    for (size_t i = 0; i < fresh.getVertexCount(); ++i) {
+        if (fresh.getVertices()[i] != graph.getVertices()[i]) return false;
+    }
+    for (size_t i = 0; i < fresh.getIndexCount(); ++i) {
+        if (fresh.getIndices()[i] != graph.getIndices()[i]) return false;
+    }
+    return true;
+}
+
+int g_failures = 0;
+
+void check(bool condition, const std::string& name) {
+    std::cout << (condition ? "PASS " : "FAIL ") << name << "\n";
+    if (!condition) ++g_failures;
+}
+
+// 生成两次初始图形填满两个缓冲区，再连续拖动一个几何参数 steps 次；apply 把参数改成第 i 次拖动的值
+template <typename Apply>
+void runDrag(const char* name, Parameters params, Apply apply, bool weld, int steps) {
+    params.weld_vertices = weld;
+    Viewer viewer;
+    viewer.show(params);
+    apply(params, 0);
+    viewer.show(params);
+    size_t retired_before = viewer.getRetiredCount();
+    AsyncGenerator::Stats before = viewer.getStats();
+
+    bool matches = true;
+    for (int i = 1; i <= steps; ++i) {
+        apply(params, i);
+        viewer.show(params);
+        matches = matches && sameAsFreshGenerate(viewer.getGraph());
+    }
+    AsyncGenerator::Stats after = viewer.getStats();
+    std::string prefix = std::string(name) + (weld ? " (welded)" : "");
+
+    // 前两次之后两个缓冲区都是同一拓扑，之后的每次拖动都只更新坐标；开启焊接时坐标变化也要整体重建
+    if (weld) check(after.rebuilds - before.rebuilds == static_cast<size_t>(steps), prefix + ": every drag step rebuilds");
+    else check(after.positionUpdates - before.positionUpdates == static_cast<size_t>(steps), prefix + ": every drag step only updates positions");
+    check(viewer.getRetiredCount() == retired_before, prefix + ": drag steps are not retired into the cache");
+    check(matches, prefix + ": dragged results match a fresh generate");
+
+    // 拓扑参数变化时旧图形交给缓存
+    Parameters finer = params;
+    if (params.shape == ShapeType::TORUS) finer.torus_main_segments += 2;
+    else finer.cube_segments += 1;
+    GraphChange change = viewer.show(finer);
+    check(change == GraphChange::TOPOLOGY && viewer.getRetiredCount() == retired_before + 1,
+        prefix + ": a topology change retires the shown graph");
+}
+
+}
+
+int main() {
+    Parameters torus;
+    torus.shape = ShapeType::TORUS;
+    torus.torus_main_segments = 120;
+    torus.torus_tube_segments = 40;
+    auto drag_tube_radius = [](Parameters& params, int step) { params.torus_tube_radius = 0.3f + 0.01f * step; };
+    runDrag("torus tube radius", torus, drag_tube_radius, false, 6);
+    runDrag("torus tube radius", torus, drag_tube_radius, true, 4);
+
+    Parameters cube;
+    cube.shape = ShapeType::CUBE;
+    cube.cube_segments = 12;
+    auto drag_cube_size = [](Parameters& params, int step) { params.cube_size = 1.5f + 0.05f * step; };
+    runDrag("cube size", cube, drag_cube_size, false, 6);
+
+    if (g_failures > 0) std::cout << g_failures << " check(s) failed\n";
+    return g_failures == 0 ? 0 : 1;
+}
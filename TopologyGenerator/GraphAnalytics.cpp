@@ -0,0 +1,305 @@
+#include "GraphAnalytics.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+// 骞惰#include "GraphAnalytics.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+// 并行时每块至少处理的元素数，太小的块调度开销比计算还大
+const size_t kMinParallelItems = 16384;
+// BFS 每层的边界小于这个数时直接在当前线程扩展
+const size_t kMinParallelFrontier = 1024;
+
+// 没有线程池或工作量太小时直接在当前线程执行
+void forRange(ThreadPool* pool, size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    if (!pool || count <= minChunk) {
+        body(0, count);
+        return;
+    }
+    pool->parallelFor(0, count, minChunk, body);
+}
+
+// std::atomic 不能放进 std::vector 里调整大小，用定长数组代替，初始值并行写入
+template <typename T>
+std::unique_ptr<std::atomic<T>[]> makeAtomicArray(size_t count, ThreadPool* pool, const std::function<T(size_t)>& initial) {
+    std::unique_ptr<std::atomic<T>[]> values(new std::atomic<T>[count]);
+    forRange(pool, count, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) values[i].store(initial(i), std::memory_order_relaxed);
+    });
+    return values;
+}
+
+// 带路径减半的查找：parent 只会指向编号更小的祖先，并发修改也不会破坏这一点
+unsigned int findRoot(std::atomic<unsigned int>* parent, unsigned int v) {
+    for (;;) {
+        unsigned int p = parent[v].load(std::memory_order_relaxed);
+        if (p == v) return v;
+        unsigned int grandparent = parent[p].load(std::memory_order_relaxed);
+        if (grandparent != p) parent[v].compare_exchange_weak(p, grandparent, std::memory_order_relaxed);
+        v = grandparent;
+    }
+}
+
+// 合并两个集合，总是把编号大的根挂到编号小的根下，最终每个分量的根都是其中编号最小的顶点
+void unite(std::atomic<unsigned int>* parent, unsigned int a, unsigned int b) {
+    for (;;) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b) return;
+        if (a < b) std::swap(a, b);
+        unsigned int expected = a;
+        if (parent[a].compare_exchange_strong(expected, b)) return;
+    }
+}
+
+// 距离最远的可达顶点，距离相同时取编号最小的，保证结果与线程数无关
+struct Farthest {
+    unsigned int distance = 0;
+    unsigned int vertex = 0;
+    size_t reached = 0;
+};
+
+Farthest findFarthest(const std::vector<unsigned int>& distances, unsigned int source, ThreadPool* pool) {
+    Farthest result;
+    result.vertex = source;
+    std::mutex mutex;
+    forRange(pool, distances.size(), kMinParallelItems, [&](size_t begin, size_t end) {
+        Farthest local;
+        local.vertex = source;
+        for (size_t v = begin; v < end; ++v) {
+            unsigned int d = distances[v];
+            if (d == GraphAnalytics::kUnreached) continue;
+            ++local.reached;
+            if (d > local.distance || (d == local.distance && v < local.vertex)) {
+                local.distance = d;
+                local.vertex = static_cast<unsigned int>(v);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        result.reached += local.reached;
+        if (local.distance > result.distance || (local.distance == result.distance && local.vertex < result.vertex)) {
+            result.distance = local.distance;
+            result.vertex = local.vertex;
+        }
+    });
+    return result;
+}
+
+}
+
+namespace GraphAnalytics {
+
+void buildAdjacency(ArrayView<unsigned int> indices, size_t vertexCount, CsrAdjacency& adjacency, ThreadPool* pool) {
+    const size_t n = vertexCount;
+    const size_t edge_count = indices.size() / 2;
+
+    // 统计每个顶点的度数，自环边和越界的索引不计入
+    auto cursor = makeAtomicArray<size_t>(n, pool, [](size_t) { return size_t(0); });
+    forRange(pool, edge_count, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            unsigned int a = indices[e * 2];
+            unsigned int b = indices[e * 2 + 1];
+            if (a == b || a >= n || b >= n) continue;
+            cursor[a].fetch_add(1, std::memory_order_relaxed);
+            cursor[b].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // 分块求前缀和：先并行求每块的和，再顺序累加块的起点，最后并行写出每个顶点的起点
+    // 顶点的起点同时作为填充邻居时的写入位置
+    adjacency.offsets.resize(n + 1);
+    size_t block_size = std::max(kMinParallelItems, pool ? (n + pool->getThreadCount() * 4) / (pool->getThreadCount() * 4 + 1) : n);
+    size_t block_count = n == 0 ? 0 : (n + block_size - 1) / block_size;
+    std::vector<size_t> block_start(block_count + 1, 0);
+    forRange(pool, block_count, 1, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            size_t sum = 0;
+            for (size_t v = block * block_size; v < std::min(n, (block + 1) * block_size); ++v) {
+                sum += cursor[v].load(std::memory_order_relaxed);
+            }
+            block_start[block + 1] = sum;
+        }
+    });
+    for (size_t block = 0; block < block_count; ++block) block_start[block + 1] += block_start[block];
+    forRange(pool, block_count, 1, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            size_t offset = block_start[block];
+            for (size_t v = block * block_size; v < std::min(n, (block + 1) * block_size); ++v) {
+                size_t degree = cursor[v].load(std::memory_order_relaxed);
+                adjacency.offsets[v] = offset;
+                cursor[v].store(offset, std::memory_order_relaxed);
+                offset += degree;
+            }
+        }
+    });
+    adjacency.offsets[n] = block_start[block_count];
+
+    // 并行填充邻居，同一个顶点的邻居写入顺序不确定，之后逐个顶点排序
+    adjacency.neighbors.resize(adjacency.offsets[n]);
+    forRange(pool, edge_count, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            unsigned int a = indices[e * 2];
+            unsigned int b = indices[e * 2 + 1];
+            if (a == b || a >= n || b >= n) continue;
+            adjacency.neighbors[cursor[a].fetch_add(1, std::memory_order_relaxed)] = b;
+            adjacency.neighbors[cursor[b].fetch_add(1, std::memory_order_relaxed)] = a;
+        }
+    });
+    forRange(pool, n, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            std::sort(adjacency.neighbors.begin() + adjacency.offsets[v], adjacency.neighbors.begin() + adjacency.offsets[v + 1]);
+        }
+    });
+}
+
+std::vector<size_t> degreeHistogram(const CsrAdjacency& adjacency, ThreadPool* pool) {
+    std::vector<size_t> histogram;
+    std::mutex mutex;
+    forRange(pool, adjacency.getVertexCount(), kMinParallelItems, [&](size_t begin, size_t end) {
+        std::vector<size_t> local;
+        for (size_t v = begin; v < end; ++v) {
+            size_t degree = adjacency.getDegree(v);
+            if (degree >= local.size()) local.resize(degree + 1, 0);
+            ++local[degree];
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (local.size() > histogram.size()) histogram.resize(local.size(), 0);
+        for (size_t d = 0; d < local.size(); ++d) histogram[d] += local[d];
+    });
+    return histogram;
+}
+
+size_t connectedComponents(const CsrAdjacency& adjacency, std::vector<unsigned int>& labels, ThreadPool* pool) {
+    const size_t n = adjacency.getVertexCount();
+    auto parent = makeAtomicArray<unsigned int>(n, pool, [](size_t v) { return static_cast<unsigned int>(v); });
+
+    // 无锁并查集：每条边只在编号较小的端点处理一次
+    forRange(pool, n, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            for (size_t k = adjacency.offsets[v]; k < adjacency.offsets[v + 1]; ++k) {
+                unsigned int u = adjacency.neighbors[k];
+                if (u > v) unite(parent.get(), static_cast<unsigned int>(v), u);
+            }
+        }
+    });
+
+    labels.resize(n);
+    std::atomic<size_t> component_count{ 0 };
+    forRange(pool, n, kMinParallelItems, [&](size_t begin, size_t end) {
+        size_t roots = 0;
+        for (size_t v = begin; v < end; ++v) {
+            labels[v] = findRoot(parent.get(), static_cast<unsigned int>(v));
+            if (labels[v] == v) ++roots;
+        }
+        component_count += roots;
+    });
+    return component_count;
+}
+
+std::vector<unsigned int> bfsDistances(const CsrAdjacency& adjacency, unsigned int source, ThreadPool* pool) {
+    const size_t n = adjacency.getVertexCount();
+    std::vector<unsigned int> distances(n, kUnreached);
+    if (source >= n) return distances;
+
+    // 访问标记用原子变量，同一层里多个线程同时发现同一个顶点时只有一个能加入下一层
+    auto visited = makeAtomicArray<unsigned int>(n, pool, [](size_t) { return kUnreached; });
+    visited[source].store(0, std::memory_order_relaxed);
+
+    std::vector<unsigned int> frontier{ source };
+    std::vector<unsigned int> next;
+    std::mutex mutex;
+    for (unsigned int level = 1; !frontier.empty(); ++level) {
+        next.clear();
+        auto expand = [&](size_t begin, size_t end) {
+            std::vector<unsigned int> local;
+            for (size_t i = begin; i < end; ++i) {
+                unsigned int v = frontier[i];
+                for (size_t k = adjacency.offsets[v]; k < adjacency.offsets[v + 1]; ++k) {
+                    unsigned int u = adjacency.neighbors[k];
+                    unsigned int expected = kUnreached;
+                    if (visited[u].load(std::memory_order_relaxed) == kUnreached &&
+                        visited[u].compare_exchange_strong(expected, level, std::memory_order_relaxed)) {
+                        local.push_back(u);
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            next.insert(next.end(), local.begin(), local.end());
+        };
+        forRange(pool, frontier.size(), kMinParallelFrontier, expand);
+        frontier.swap(next);
+    }
+
+    forRange(pool, n, kMinParallelItems, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) distances[v] = visited[v].load(std::memory_order_relaxed);
+    });
+    return distances;
+}
+
+unsigned int approximateDiameter(const CsrAdjacency& adjacency, unsigned int start, ThreadPool* pool, int sweeps) {
+    if (start >= adjacency.getVertexCount()) return 0;
+    // 每轮从上一轮的最远点出发，最远距离是直径的下界，对网格类的图通常两三轮就等于真实直径
+    unsigned int best = 0;
+    unsigned int vertex = start;
+    for (int sweep = 0; sweep < sweeps; ++sweep) {
+        Farthest farthest = findFarthest(bfsDistances(adjacency, vertex, pool), vertex, pool);
+        if (sweep > 0 && farthest.distance <= best) break;
+        best = std::max(best, farthest.distance);
+        vertex = farthest.vertex;
+    }
+    return best;
+}
+
+GraphMetrics analyze(const TopologyGraph& graph, unsigned int source, ThreadPool* pool) {
+    GraphMetrics metrics;
+    CsrAdjacency adjacency;
+    buildAdjacency(graph.getIndices(), graph.getVertexCount(), adjacency, pool);
+
+    const size_t n = adjacency.getVertexCount();
+    metrics.vertexCount = n;
+    metrics.edgeCount = adjacency.neighbors.size() / 2;
+    if (n == 0) return metrics;
+
+    metrics.degreeHistogram = degreeHistogram(adjacency, pool);
+    // 直方图的最后一项一定非零
+    while (metrics.degreeHistogram[metrics.minDegree] == 0) ++metrics.minDegree;
+    metrics.maxDegree = metrics.degreeHistogram.size() - 1;
+    metrics.averageDegree = 2.0 * metrics.edgeCount / n;
+
+    // 分量大小按根（分量内编号最小的顶点）统计
+    std::vector<unsigned int> labels;
+    metrics.componentCount = connectedComponents(adjacency, labels, pool);
+    std::vector<size_t> sizes(n, 0);
+    for (unsigned int label : labels) ++sizes[label];
+    unsigned int largest_root = 0;
+    for (size_t v = 0; v < n; ++v) {
+        if (sizes[v] > metrics.largestComponentSize) {
+            metrics.largestComponentSize = sizes[v];
+            largest_root = static_cast<unsigned int>(v);
+        }
+    }
+
+    metrics.bfsSource = source < n ? source : 0;
+    Farthest farthest = findFarthest(bfsDistances(adjacency, metrics.bfsSource, pool), metrics.bfsSource, pool);
+    metrics.reachedCount = farthest.reached;
+    metrics.eccentricity = farthest.distance;
+
+    metrics.approximateDiameter = approximateDiameter(adjacency, largest_root, pool);
+    return metrics;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 鍘嬬缉绋€鐤忚#pragma once
+#include <vector>
+#include <cstddef>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 压缩稀疏行（CSR）格式的邻接表：顶点 v 的邻居为 neighbors[offsets[v], offsets[v + 1])
+// 每条边在两个端点下各出现一次，每个顶点的邻居按编号升序排列，构建结果与线程数无关
+struct CsrAdjacency {
+    std::vector<size_t> offsets;
+    std::vector<unsigned int> neighbors;
+
+    size_t getVertexCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    size_t getDegree(size_t vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+};
+
+// 图的统计结果，用于检查生成的拓扑是否符合预期
+struct GraphMetrics {
+    size_t vertexCount = 0;
+    size_t edgeCount = 0;
+
+    // degreeHistogram[d] 为度数等于 d 的顶点数
+    std::vector<size_t> degreeHistogram;
+    size_t minDegree = 0;
+    size_t maxDegree = 0;
+    double averageDegree = 0.0;
+
+    // 连通分量数和最大连通分量的顶点数
+    size_t componentCount = 0;
+    size_t largestComponentSize = 0;
+
+    // 从 bfsSource 出发的广度优先搜索：可达顶点数和离心率（到最远可达顶点的距离）
+    unsigned int bfsSource = 0;
+    size_t reachedCount = 0;
+    unsigned int eccentricity = 0;
+
+    // 最大连通分量的近似直径：多次双向扫描得到的下界
+    unsigned int approximateDiameter = 0;
+};
+
+// 图分析，不依赖任何图形库；传入线程池时各步骤并行执行，结果与单线程完全一致
+namespace GraphAnalytics {
+    // BFS 距离数组中不可达顶点的取值
+    const unsigned int kUnreached = 0xFFFFFFFFu;
+
+    // 由 GL_LINES 形式的索引（每两个索引一条边）构建邻接表，自环边会被忽略
+    void buildAdjacency(ArrayView<unsigned int> indices, size_t vertexCount, CsrAdjacency& adjacency, ThreadPool* pool = nullptr);
+
+    // 度数直方图，下标为度数
+    std::vector<size_t> degreeHistogram(const CsrAdjacency& adjacency, ThreadPool* pool = nullptr);
+
+    // 连通分量标号：labels[v] 为 v 所在分量中编号最小的顶点，返回分量数
+    size_t connectedComponents(const CsrAdjacency& adjacency, std::vector<unsigned int>& labels, ThreadPool* pool = nullptr);
+
+    // 逐层并行的广度优先搜索，返回每个顶点到 source 的距离，不可达为 kUnreached
+    std::vector<unsigned int> bfsDistances(const CsrAdjacency& adjacency, unsigned int source, ThreadPool* pool = nullptr);
+
+    // 从 start 出发反复 BFS 到最远点再从最远点出发（双扫描），最多 sweeps 次，结果不再增大时提前结束
+    // 返回 start 所在分量直径的下界
+    unsigned int approximateDiameter(const CsrAdjacency& adjacency, unsigned int start, ThreadPool* pool = nullptr, int sweeps = 4);
+
+    // 一次算出全部统计；source 超出范围时使用 0 号顶点
+    GraphMetrics analyze(const TopologyGraph& graph, unsigned int source, ThreadPool* pool = nullptr);
+}
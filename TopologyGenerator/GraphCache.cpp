@@ -0,0 +1,104 @@
+#include "GraphCache.h"
+#include <utility>
+#include <iterator>
+
+void GraphCache::destroy() {
+    clear();
+}
+
+void GraphCache::setBudget(size_t bytes) {
+    m_budget = bytes;
+    trim();
+}
+
+size_t GraphCache::getGraphBytes(const TopologyGraph& graph) {
+    size_t cpu_bytes = graph.getVertexCount() * sizeof(glm::vec3) + graph.getIndexCount() * sizeof(unsigned int) +
+        graph.getPackedPositions().size() * sizeof(uint16_t) + graph.getShortIndices().size() * sizeof(uint16_t);
+    // GPU 涓婂彧鏈夊疄闄呬笂浼犵殑涓€浠斤細绱у噾鍧愭爣鎴#include "GraphCache.h"
+#include <utility>
+#include <iterator>
+
+void GraphCache::destroy() {
+    clear();
+}
+
+void GraphCache::setBudget(size_t bytes) {
+    m_budget = bytes;
+    trim();
+}
+
+size_t GraphCache::getGraphBytes(const TopologyGraph& graph) {
+    size_t cpu_bytes = graph.getVertexCount() * sizeof(glm::vec3) + graph.getIndexCount() * sizeof(unsigned int) +
+        graph.getPackedPositions().size() * sizeof(uint16_t) + graph.getShortIndices().size() * sizeof(uint16_t);
+    // GPU 上只有实际上传的一份：紧凑坐标或 32 位坐标，16 位或 32 位索引
+    size_t gpu_bytes = graph.getVertexCount() * TopologyGraph::getPositionStride(graph.getPositionFormat()) +
+        graph.getIndexCount() * (graph.hasShortIndices() ? sizeof(uint16_t) : sizeof(unsigned int));
+    return cpu_bytes + gpu_bytes;
+}
+
+std::list<GraphCache::Entry>::iterator GraphCache::find(const Parameters& params) {
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (TopologyGraph::classifyChange(it->graph.getParameters(), params) == GraphChange::NONE) return it;
+    }
+    return m_entries.end();
+}
+
+void GraphCache::insert(TopologyGraph& graph, const ResidentMesh& mesh) {
+    auto existing = find(graph.getParameters());
+    if (existing != m_entries.end()) erase(existing);
+
+    m_entries.emplace_front();
+    Entry& entry = m_entries.front();
+    std::swap(entry.graph, graph);
+    entry.mesh = mesh;
+    entry.bytes = getGraphBytes(entry.graph);
+    m_stats.bytes += entry.bytes;
+    ++m_stats.entries;
+    trim();
+}
+
+bool GraphCache::take(const Parameters& params, TopologyGraph& graph, ResidentMesh& mesh) {
+    auto it = find(params);
+    if (it == m_entries.end()) {
+        ++m_stats.misses;
+        return false;
+    }
+    ++m_stats.hits;
+    std::swap(graph, it->graph);
+    mesh = it->mesh;
+    it->mesh = ResidentMesh();
+    erase(it);
+    return true;
+}
+
+bool GraphCache::contains(const Parameters& params) const {
+    for (const Entry& entry : m_entries) {
+        if (TopologyGraph::classifyChange(entry.graph.getParameters(), params) == GraphChange::NONE) return true;
+    }
+    return false;
+}
+
+void GraphCache::clear() {
+    while (!m_entries.empty()) erase(m_entries.begin());
+}
+
+void GraphCache::releaseMesh(ResidentMesh& mesh) {
+    if (mesh.vao) glDeleteVertexArrays(1, &mesh.vao);
+    if (mesh.vertexBuffer) glDeleteBuffers(1, &mesh.vertexBuffer);
+    if (mesh.indexBuffer) glDeleteBuffers(1, &mesh.indexBuffer);
+    mesh = ResidentMesh();
+}
+
+void GraphCache::erase(std::list<Entry>::iterator it) {
+    releaseMesh(it->mesh);
+    m_stats.bytes -= it->bytes;
+    --m_stats.entries;
+    m_entries.erase(it);
+}
+
+void GraphCache::trim() {
+    while (!m_entries.empty() && m_stats.bytes > m_budget) {
+        erase(std::prev(m_entries.end()));
+        ++m_stats.evictions;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <glad/glad.h>
+#include <list>
+#include <cstddef>
+#include "TopologyGraph.h"
+
+// 甯搁┗ GPU 鐨勪竴浠藉浘褰㈡暟鎹#pragma once
+#include <glad/glad.h>
+#include <list>
+#include <cstddef>
+#include "TopologyGraph.h"
+
+// 常驻 GPU 的一份图形数据：独立的顶点缓冲区、索引缓冲区和记录了它们的 VAO
+// 数据从流式缓冲区在 GPU 上直接复制过来，不经过 CPU
+struct ResidentMesh {
+    GLuint vao = 0;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+};
+
+// 最近用过的图形的缓存：拖动滑动条回到用过的值时，直接换回缓存中的图形并绑定它的 VAO，不重新生成也不重新上传
+// 条目按 TopologyGraph::classifyChange 判断参数是否相同，任何影响图形或输出编码的字段不同都不会命中
+// 总字节数（CPU 数据加 GPU 缓冲区）超过预算时淘汰最久没有用到的条目；所有函数都只能在渲染线程调用
+class GraphCache {
+public:
+    GraphCache() = default;
+    GraphCache(const GraphCache&) = delete;
+    GraphCache& operator=(const GraphCache&) = delete;
+
+    // 释放全部条目的 GL 资源，必须在 GL 上下文销毁之前调用
+    void destroy();
+
+    // 预算为 0 时不缓存；调小时立即淘汰多出来的条目
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return m_budget; }
+
+    // 图形放进缓存后占用的字节数，CPU 和 GPU 两份数据都算在内
+    static size_t getGraphBytes(const TopologyGraph& graph);
+    // 只有单个图形就不超过预算时才值得缓存
+    bool accepts(const TopologyGraph& graph) const { return m_budget > 0 && getGraphBytes(graph) <= m_budget; }
+
+    // 放入一个图形，graph 和缓存中的空图形交换，调用后 graph 为空；mesh 的 GL 资源归缓存所有
+    // 已有相同参数的条目时替换它
+    void insert(TopologyGraph& graph, const ResidentMesh& mesh);
+    // 查找和 params 生成结果相同的条目，命中时把图形交换给 graph、GL 资源交给 mesh，并从缓存中移除
+    bool take(const Parameters& params, TopologyGraph& graph, ResidentMesh& mesh);
+    // 只查找，不改变条目顺序，也不计入命中和未命中次数
+    bool contains(const Parameters& params) const;
+    void clear();
+
+    static void releaseMesh(ResidentMesh& mesh);
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        TopologyGraph graph;
+        ResidentMesh mesh;
+        size_t bytes = 0;
+    };
+    // 最近放入的在前，淘汰从末尾开始
+    std::list<Entry> m_entries;
+    size_t m_budget = 512u << 20;
+    Stats m_stats;
+
+    std::list<Entry>::iterator find(const Parameters& params);
+    void erase(std::list<Entry>::iterator it);
+    void trim();
+};
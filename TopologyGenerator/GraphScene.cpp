@@ -0,0 +1,106 @@
+#include "GraphScene.h"
+#include "ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+void GraphScene::clear() {
+    m_items.clear();
+    m_vertices.clear();
+    m_itemIds.clear();
+    m_indices.clear();
+    m_columns = 0;
+    m_rows = 0;
+}
+
+void GraphScene::build(const std::vector<SceneItem>& items, ThreadPool* pool) {
+    clear();
+    m_items = items;
+    size_t item_count = m_items.size();
+    if (item_count == 0) return;
+
+    // 鍥惧舰鏁伴噺閫氬父姣旂嚎绋嬫暟澶氾紝鎸夊浘褰㈠苟琛岋紝姣忎釜鍥惧舰鍐呴儴鍗曠嚎绋嬬敓鎴#include "GraphScene.h"
+#include "ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+void GraphScene::clear() {
+    m_items.clear();
+    m_vertices.clear();
+    m_itemIds.clear();
+    m_indices.clear();
+    m_columns = 0;
+    m_rows = 0;
+}
+
+void GraphScene::build(const std::vector<SceneItem>& items, ThreadPool* pool) {
+    clear();
+    m_items = items;
+    size_t item_count = m_items.size();
+    if (item_count == 0) return;
+
+    // 图形数量通常比线程数多，按图形并行，每个图形内部单线程生成
+    std::vector<TopologyGraph> graphs(item_count);
+    auto generate = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) graphs[i].generate(m_items[i].params);
+    };
+    if (pool) pool->parallelFor(0, item_count, 1, generate);
+    else generate(0, item_count);
+
+    size_t vertex_count = 0;
+    size_t index_count = 0;
+    for (size_t i = 0; i < item_count; ++i) {
+        SceneItem& item = m_items[i];
+        item.vertexOffset = vertex_count;
+        item.vertexCount = graphs[i].getVertexCount();
+        item.indexOffset = index_count;
+        item.indexCount = graphs[i].getIndexCount();
+        vertex_count += item.vertexCount;
+        index_count += item.indexCount;
+    }
+    m_vertices.resize(vertex_count);
+    m_itemIds.resize(vertex_count);
+    m_indices.resize(index_count);
+
+    // 各图形写入互不重叠的区间，同样可以并行复制
+    auto copy = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            SceneItem& item = m_items[i];
+            ArrayView<glm::vec3> vertices = graphs[i].getVertices();
+            ArrayView<unsigned int> indices = graphs[i].getIndices();
+            std::copy(vertices.begin(), vertices.end(), m_vertices.begin() + item.vertexOffset);
+            std::fill_n(m_itemIds.begin() + item.vertexOffset, item.vertexCount, static_cast<unsigned int>(i));
+            std::copy(indices.begin(), indices.end(), m_indices.begin() + item.indexOffset);
+
+            float radius_squared = 0.0f;
+            for (const glm::vec3& vertex : vertices) radius_squared = std::max(radius_squared, glm::dot(vertex, vertex));
+            item.radius = std::sqrt(radius_squared);
+
+            // 每个图形的数据复制完就释放，峰值内存不超过场景本身加上尚未复制的图形
+            graphs[i] = TopologyGraph();
+        }
+    };
+    if (pool) pool->parallelFor(0, item_count, 1, copy);
+    else copy(0, item_count);
+}
+
+void GraphScene::layoutGrid(float spacing) {
+    size_t item_count = m_items.size();
+    if (item_count == 0) return;
+    m_columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(item_count))));
+    m_rows = static_cast<int>((item_count + m_columns - 1) / m_columns);
+
+    float max_radius = 0.0f;
+    for (const SceneItem& item : m_items) max_radius = std::max(max_radius, item.radius);
+    // 留出一点间隙，相邻图形不会接触
+    float scale = max_radius > 0.0f ? 0.45f * spacing / max_radius : 1.0f;
+
+    for (size_t i = 0; i < item_count; ++i) {
+        int column = static_cast<int>(i % m_columns);
+        int row = static_cast<int>(i / m_columns);
+        // 第一个图形在左上角，向右、向下排列
+        glm::vec3 center((column - (m_columns - 1) * 0.5f) * spacing, ((m_rows - 1) * 0.5f - row) * spacing, 0.0f);
+        m_items[i].transform = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale));
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 鍦烘櫙涓#pragma once
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 场景中的一个图形：参数、变换，以及生成后在场景共享数组中的范围
+struct SceneItem {
+    Parameters params;
+    glm::mat4 transform = glm::mat4(1.0f);
+    size_t vertexOffset = 0;
+    size_t vertexCount = 0;
+    size_t indexOffset = 0;
+    size_t indexCount = 0;
+    // 顶点到原点的最大距离
+    float radius = 0.0f;
+};
+
+// 多图形场景：每个图形有自己的参数和变换，所有图形的顶点和索引依次存放在共享数组中
+// 索引保持图形内的局部编号，绘制时以 vertexOffset 作为基准顶点；每个顶点另带所属图形的序号，着色器据此取出该图形的变换
+class GraphScene {
+public:
+    // 按 items 中的参数生成所有图形并合并，各图形在线程池中并行生成
+    void build(const std::vector<SceneItem>& items, ThreadPool* pool = nullptr);
+    void clear();
+
+    // 把图形按顺序排成接近正方形的网格，格子边长为 spacing，整个网格的中心在原点
+    // 所有图形使用同一个缩放，最大的图形刚好放进一个格子，不同参数之间的大小关系保持不变
+    void layoutGrid(float spacing);
+
+    const std::vector<SceneItem>& getItems() const { return m_items; }
+    const std::vector<glm::vec3>& getVertices() const { return m_vertices; }
+    // 每个顶点所属图形的序号
+    const std::vector<unsigned int>& getItemIds() const { return m_itemIds; }
+    const std::vector<unsigned int>& getIndices() const { return m_indices; }
+    // 网格的列数和行数，layoutGrid 之前为 0
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+
+private:
+    std::vector<SceneItem> m_items;
+    std::vector<glm::vec3> m_vertices;
+    std::vector<unsigned int> m_itemIds;
+    std::vector<unsigned int> m_indices;
+    int m_columns = 0;
+    int m_rows = 0;
+};
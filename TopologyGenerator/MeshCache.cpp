@@ -0,0 +1,374 @@
+#include "MeshCache.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+// 闃叉#include "MeshCache.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+// 防止 windows.h 定义 min 和 max 宏
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 影响图形的全部字段，按形状规整后逐字节比较，哈希冲突时也不会用错文件
+// 所有成员都是 4 字节，没有填充
+struct CacheKey {
+    int32_t shape;
+    int32_t beautify;
+    int32_t weld;
+    int32_t integers[3];
+    float reals[2];
+};
+
+struct CacheFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    CacheKey key;
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+};
+
+const char kMagic[8] = { 'T', 'G', 'M', 'E', 'S', 'H', '\0', '\0' };
+// 顶点和索引数组的起始位置按缓存行对齐
+const uint64_t kDataAlignment = 64;
+const char* kExtension = ".mesh";
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+}
+
+CacheKey makeKey(const Parameters& params) {
+    CacheKey key{};
+    key.shape = static_cast<int32_t>(params.shape);
+    key.beautify = params.beautify ? 1 : 0;
+    key.weld = params.weld_vertices ? 1 : 0;
+    switch (params.shape) {
+    case ShapeType::TOPOLOGY_2D:
+        key.integers[0] = params.topology_sides;
+        key.integers[1] = params.topology_points_per_sector;
+        break;
+    case ShapeType::SPHERE:
+        key.integers[0] = params.sphere_sectors;
+        key.integers[1] = params.sphere_points_per_sector;
+        key.integers[2] = params.sphere_layers;
+        break;
+    case ShapeType::TORUS:
+        key.integers[0] = params.torus_main_segments;
+        key.integers[1] = params.torus_tube_segments;
+        key.reals[0] = params.torus_main_radius;
+        key.reals[1] = params.torus_tube_radius;
+        break;
+    case ShapeType::CUBE:
+        key.integers[0] = params.cube_segments;
+        key.reals[0] = params.cube_size;
+        break;
+    default:
+        break;
+    }
+    return key;
+}
+
+// 只读映射整个文件，失败时返回 nullptr
+void* mapFile(const std::string& path, size_t& bytes) {
+#ifdef _WIN32
+    std::wstring wide_path = std::filesystem::path(path).wstring();
+    HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return nullptr;
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // 映射视图会保持文件打开，句柄可以马上关闭
+    CloseHandle(mapping);
+    if (!address) return nullptr;
+    bytes = static_cast<size_t>(size.QuadPart);
+    return address;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) return nullptr;
+    bytes = static_cast<size_t>(info.st_size);
+    // 马上就要整块上传，提前让内核预读
+    madvise(address, bytes, MADV_WILLNEED);
+    return address;
+#endif
+}
+
+void unmapFile(void* address, size_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    UnmapViewOfFile(address);
+#else
+    munmap(address, bytes);
+#endif
+}
+
+}
+
+CachedMesh::~CachedMesh() {
+    if (m_mapping) unmapFile(m_mapping, m_mappingBytes);
+}
+
+MeshCache::MeshCache(const std::string& directory)
+    : m_directory(directory) {
+}
+
+MeshCache::~MeshCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_stopWriter = true;
+        m_writeQueue.clear();
+    }
+    m_writeCv.notify_all();
+    if (m_writer.joinable()) m_writer.join();
+}
+
+uint64_t MeshCache::hashParameters(const Parameters& params) {
+    CacheKey key = makeKey(params);
+    // FNV-1a，版本号也参与哈希，格式改变后文件名随之改变
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    uint32_t version = kVersion;
+    mix(&version, sizeof(version));
+    mix(&key, sizeof(key));
+    return hash;
+}
+
+std::string MeshCache::makePath(uint64_t hash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(m_directory) / (std::string(name) + kExtension)).string();
+}
+
+std::shared_ptr<const CachedMesh> MeshCache::load(const Parameters& params) {
+    if (!m_enabled) return nullptr;
+    CacheKey key = makeKey(params);
+    std::string path = makePath(hashParameters(params));
+
+    std::shared_ptr<CachedMesh> mesh(new CachedMesh());
+    mesh->m_mapping = mapFile(path, mesh->m_mappingBytes);
+
+    // 文件头和各段范围都检查一遍，不完整或者版本不同的文件当作未命中
+    bool valid = false;
+    if (mesh->m_mapping && mesh->m_mappingBytes >= sizeof(CacheFileHeader)) {
+        CacheFileHeader header;
+        std::memcpy(&header, mesh->m_mapping, sizeof(header));
+        uint64_t vertex_bytes = header.vertexCount * sizeof(glm::vec3);
+        uint64_t index_bytes = header.indexCount * sizeof(unsigned int);
+        valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+            header.version == kVersion && header.headerSize == sizeof(CacheFileHeader) &&
+            std::memcmp(&header.key, &key, sizeof(key)) == 0 &&
+            header.vertexOffset >= sizeof(CacheFileHeader) && header.vertexOffset % kDataAlignment == 0 &&
+            header.indexOffset >= header.vertexOffset + vertex_bytes && header.indexOffset % kDataAlignment == 0 &&
+            header.indexOffset + index_bytes == mesh->m_mappingBytes;
+        if (valid) {
+            const char* base = static_cast<const char*>(mesh->m_mapping);
+            mesh->m_vertices = reinterpret_cast<const glm::vec3*>(base + header.vertexOffset);
+            mesh->m_indices = reinterpret_cast<const unsigned int*>(base + header.indexOffset);
+            mesh->m_vertexCount = static_cast<size_t>(header.vertexCount);
+            mesh->m_indexCount = static_cast<size_t>(header.indexCount);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (valid) {
+            ++m_stats.hits;
+            m_stats.lastHitBytes = mesh->m_mappingBytes;
+        }
+        else {
+            ++m_stats.misses;
+        }
+    }
+    if (!valid) return nullptr;
+
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return mesh;
+}
+
+bool MeshCache::store(const Parameters& params, const glm::vec3* vertices, size_t vertexCount,
+    const unsigned int* indices, size_t indexCount) {
+    if (!m_enabled) return false;
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec) return false;
+
+    CacheFileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(CacheFileHeader);
+    header.key = makeKey(params);
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.vertexOffset = alignUp(sizeof(CacheFileHeader));
+    header.indexOffset = alignUp(header.vertexOffset + vertexCount * sizeof(glm::vec3));
+
+    std::string path = makePath(hashParameters(params));
+    // 临时文件名带上时间，同时写同一个图形的多个进程互不干扰
+    std::string temp_path = path + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        const char padding[kDataAlignment] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(padding, header.vertexOffset - sizeof(header));
+        file.write(reinterpret_cast<const char*>(vertices), vertexCount * sizeof(glm::vec3));
+        file.write(padding, header.indexOffset - header.vertexOffset - vertexCount * sizeof(glm::vec3));
+        file.write(reinterpret_cast<const char*>(indices), indexCount * sizeof(unsigned int));
+        file.close();
+        if (!file) {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.writes;
+    }
+    trim();
+    return true;
+}
+
+bool MeshCache::storeAsync(const Parameters& params, std::vector<glm::vec3> vertices, std::vector<unsigned int> indices) {
+    if (!m_enabled) return false;
+    size_t bytes = vertices.size() * sizeof(glm::vec3) + indices.size() * sizeof(unsigned int);
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if (m_stopWriter || m_pendingBytes + bytes > kMaxPendingBytes) return false;
+        m_writeQueue.push_back(PendingWrite{ params, std::move(vertices), std::move(indices) });
+        m_pendingBytes += bytes;
+        if (!m_writer.joinable()) m_writer = std::thread(&MeshCache::writerLoop, this);
+    }
+    m_writeCv.notify_all();
+    return true;
+}
+
+void MeshCache::waitForWrites() {
+    std::unique_lock<std::mutex> lock(m_writeMutex);
+    m_writeCv.wait(lock, [this] { return m_writeQueue.empty() && m_writing == 0; });
+}
+
+void MeshCache::writerLoop() {
+    for (;;) {
+        PendingWrite write;
+        {
+            std::unique_lock<std::mutex> lock(m_writeMutex);
+            m_writeCv.wait(lock, [this] { return m_stopWriter || !m_writeQueue.empty(); });
+            if (m_stopWriter) return;
+            write = std::move(m_writeQueue.front());
+            m_writeQueue.pop_front();
+            m_writing = 1;
+        }
+
+        store(write.params, write.vertices.data(), write.vertices.size(), write.indices.data(), write.indices.size());
+
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            m_pendingBytes -= write.vertices.size() * sizeof(glm::vec3) + write.indices.size() * sizeof(unsigned int);
+            m_writing = 0;
+        }
+        m_writeCv.notify_all();
+    }
+}
+
+void MeshCache::trim() {
+    uint64_t max_bytes = m_maxBytes;
+    if (max_bytes == 0) return;
+
+    struct Entry {
+        std::filesystem::file_time_type time;
+        uint64_t bytes;
+        std::filesystem::path path;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator(m_directory, ec)) {
+        if (item.path().extension() != kExtension) continue;
+        std::error_code item_ec;
+        Entry entry{ item.last_write_time(item_ec), item.file_size(item_ec), item.path() };
+        if (item_ec) continue;
+        total += entry.bytes;
+        entries.push_back(entry);
+    }
+    if (total <= max_bytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const Entry& entry : entries) {
+        if (total <= max_bytes) break;
+        // 其他进程正在映射的文件在 Windows 上删不掉，跳过即可
+        if (std::filesystem::remove(entry.path, ec)) total -= entry.bytes;
+    }
+}
+
+void MeshCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        for (const PendingWrite& write : m_writeQueue) {
+            m_pendingBytes -= write.vertices.size() * sizeof(glm::vec3) + write.indices.size() * sizeof(unsigned int);
+        }
+        m_writeQueue.clear();
+    }
+    m_writeCv.notify_all();
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator(m_directory, ec)) {
+        if (item.path().extension() != kExtension) continue;
+        std::error_code item_ec;
+        std::filesystem::remove(item.path(), item_ec);
+    }
+}
+
+MeshCache::Stats MeshCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+// 缂撳瓨鏂囦欢鐨勫彧璇诲唴瀛樻槧灏勶紝鐢熷懡鍛ㄦ湡鍐呴《鐐瑰拰绱㈠紩鎸囬拡涓€鐩存湁鏁#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+// 缓存文件的只读内存映射，生命周期内顶点和索引指针一直有效
+// TopologyGraph 命中缓存时持有它，上传 GPU、导出和分析都直接读取映射的内存，不再复制
+class CachedMesh {
+public:
+    ~CachedMesh();
+    CachedMesh(const CachedMesh&) = delete;
+    CachedMesh& operator=(const CachedMesh&) = delete;
+
+    const glm::vec3* getVertices() const { return m_vertices; }
+    const unsigned int* getIndices() const { return m_indices; }
+    size_t getVertexCount() const { return m_vertexCount; }
+    size_t getIndexCount() const { return m_indexCount; }
+
+private:
+    friend class MeshCache;
+    CachedMesh() = default;
+
+    void* m_mapping = nullptr;
+    size_t m_mappingBytes = 0;
+    const glm::vec3* m_vertices = nullptr;
+    const unsigned int* m_indices = nullptr;
+    size_t m_vertexCount = 0;
+    size_t m_indexCount = 0;
+};
+
+// 生成结果的磁盘缓存：按 Parameters 中影响图形的字段（形状、美化、焊接和当前形状的参数）求哈希，
+// 每个图形存成一个带版本号的二进制文件，顶点和索引按原始内存布局存放，命中时映射整个文件直接使用
+// 只缓存生成耗时超过阈值的图形；文件先写到临时文件再改名，多个进程共用一个目录也不会读到写了一半的文件
+// load、store 和 storeAsync 可以在任意线程调用，但同一时刻只应有一个线程调用 store（storeAsync 的写入都在同一个后台线程中进行）
+class MeshCache {
+public:
+    // 生成器或文件格式改变时加一，旧文件自动失效
+    static const uint32_t kVersion = 1;
+    // 排队等待写入的数据上限，磁盘跟不上时后来的图形不再缓存
+    static const size_t kMaxPendingBytes = size_t(1) << 30;
+
+    explicit MeshCache(const std::string& directory = "mesh_cache");
+    // 丢弃还在排队的写入，等正在写的文件写完
+    ~MeshCache();
+
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+    // 生成耗时低于它的图形不写入缓存，重新生成比读文件更快
+    void setMinGenerateSeconds(double seconds) { m_minGenerateSeconds = seconds; }
+    double getMinGenerateSeconds() const { return m_minGenerateSeconds; }
+    // 缓存文件总大小的上限，写入后超出时删除最久没有用到的文件；0 表示不限制
+    void setMaxBytes(uint64_t bytes) { m_maxBytes = bytes; }
+    const std::string& getDirectory() const { return m_directory; }
+
+    // 命中时返回映射好的图形，否则返回 nullptr；命中的文件会更新修改时间，清理时最后才删除
+    std::shared_ptr<const CachedMesh> load(const Parameters& params);
+
+    // 写入一个图形，失败时返回 false，不影响调用方已有的数据
+    bool store(const Parameters& params, const glm::vec3* vertices, size_t vertexCount,
+        const unsigned int* indices, size_t indexCount);
+    // 把数据交给后台写线程写入，调用方不等待磁盘；排队的数据超过 kMaxPendingBytes 时放弃这次写入，返回 false
+    bool storeAsync(const Parameters& params, std::vector<glm::vec3> vertices, std::vector<unsigned int> indices);
+    // 等待排队的写入全部完成
+    void waitForWrites();
+
+    // 删除目录中的全部缓存文件，并丢弃还在排队的写入
+    void clear();
+
+    // 影响图形的字段的 64 位哈希，作为文件名
+    static uint64_t hashParameters(const Parameters& params);
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t writes = 0;
+        // 最近一次命中映射的文件大小
+        uint64_t lastHitBytes = 0;
+    };
+    Stats getStats() const;
+
+private:
+    std::string m_directory;
+    std::atomic<bool> m_enabled{ true };
+    std::atomic<double> m_minGenerateSeconds{ 0.25 };
+    std::atomic<uint64_t> m_maxBytes{ 4ull << 30 };
+
+    mutable std::mutex m_statsMutex;
+    Stats m_stats;
+
+    // 后台写线程，第一次 storeAsync 时才启动
+    struct PendingWrite {
+        Parameters params;
+        std::vector<glm::vec3> vertices;
+        std::vector<unsigned int> indices;
+    };
+    std::thread m_writer;
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCv;
+    std::deque<PendingWrite> m_writeQueue;
+    size_t m_pendingBytes = 0;
+    // 正在写入的文件数（0 或 1），waitForWrites 要等它也写完
+    int m_writing = 0;
+    bool m_stopWriter = false;
+
+    void writerLoop();
+
+    std::string makePath(uint64_t hash) const;
+    // 总大小超过上限时按修改时间从旧到新删除
+    void trim();
+};
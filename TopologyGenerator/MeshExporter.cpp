@@ -0,0 +1,335 @@
+#include "MeshExporter.h"
+#include "ThreadPool.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+
+// 浜岃繘鍒舵暟鎹#include "MeshExporter.h"
+#include "ThreadPool.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+
+// 二进制数据每次最多写出的字节数，大端机器上也用这个大小的暂存区做字节序转换
+const size_t kChunkBytes = 1 << 20;
+
+// OBJ 每个文本块包含的行数，多个块并行格式化后按顺序写出
+const size_t kLinesPerBlock = 1 << 14;
+
+// "%.6f" 格式下 float 最长为 "-340282346638528859811704183484516925440.000000"，共 47 个字符
+const size_t kMaxFloatChars = 48;
+const size_t kMaxVertexLineChars = 2 + 3 * (kMaxFloatChars + 1);
+// "l " 加两个 10 位无符号整数
+const size_t kMaxEdgeLineChars = 2 + 2 * 11;
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+
+bool isLittleEndian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// 打开文件并设置较大的缓冲区，减少系统调用次数
+struct OutputFile {
+    FILE* file = nullptr;
+    std::vector<char> buffer;
+
+    explicit OutputFile(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return;
+        buffer.resize(kChunkBytes);
+        std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+    }
+
+    ~OutputFile() {
+        if (file) std::fclose(file);
+    }
+
+    // 关闭文件并返回整个写入过程是否成功
+    bool close() {
+        if (!file) return false;
+        bool ok = std::ferror(file) == 0;
+        ok = (std::fclose(file) == 0) && ok;
+        file = nullptr;
+        return ok;
+    }
+};
+
+// 以小端字节序写出 count 个 wordBytes 字节的元素
+// 小端机器上直接从原数组分块写出，不复制；大端机器上逐块翻转到暂存区再写
+bool writeLittleEndian(FILE* file, const void* data, size_t count, size_t wordBytes) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    size_t total = count * wordBytes;
+    if (isLittleEndian()) {
+        for (size_t offset = 0; offset < total; offset += kChunkBytes) {
+            size_t size = std::min(kChunkBytes, total - offset);
+            if (std::fwrite(bytes + offset, 1, size, file) != size) return false;
+        }
+        return true;
+    }
+
+    std::vector<unsigned char> staging(kChunkBytes);
+    for (size_t offset = 0; offset < total; offset += kChunkBytes) {
+        size_t size = std::min(kChunkBytes, total - offset);
+        for (size_t i = 0; i < size; i += wordBytes) {
+            for (size_t k = 0; k < wordBytes; ++k) {
+                staging[i + k] = bytes[offset + i + wordBytes - 1 - k];
+            }
+        }
+        if (std::fwrite(staging.data(), 1, size, file) != size) return false;
+    }
+    return true;
+}
+
+char* appendFloat(char* out, char* end, float value) {
+    return std::to_chars(out, end, value, std::chars_format::fixed, 6).ptr;
+}
+
+char* appendUnsigned(char* out, char* end, unsigned int value) {
+    return std::to_chars(out, end, value).ptr;
+}
+
+// 把 count 行文本分块格式化后按顺序写出，formatLine(i, out, end) 写出第 i 行并返回结尾位置
+// 每批最多 blockCount 个块在线程池上并行格式化，内存占用只和块数有关，与网格大小无关
+template <typename FormatLine>
+bool writeLines(FILE* file, size_t count, size_t maxLineChars, ThreadPool* pool, FormatLine formatLine) {
+    if (count == 0) return true;
+
+    size_t blockCount = pool ? std::max<size_t>(1, pool->getThreadCount() * 2) : 1;
+    size_t totalBlocks = (count + kLinesPerBlock - 1) / kLinesPerBlock;
+    blockCount = std::min(blockCount, totalBlocks);
+
+    std::vector<std::vector<char>> blocks(blockCount, std::vector<char>(kLinesPerBlock * maxLineChars));
+    std::vector<size_t> blockSizes(blockCount, 0);
+
+    for (size_t firstBlock = 0; firstBlock < totalBlocks; firstBlock += blockCount) {
+        size_t batch = std::min(blockCount, totalBlocks - firstBlock);
+        auto formatBlocks = [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t lineBegin = (firstBlock + b) * kLinesPerBlock;
+                size_t lineEnd = std::min(count, lineBegin + kLinesPerBlock);
+                char* start = blocks[b].data();
+                char* limit = start + blocks[b].size();
+                char* out = start;
+                for (size_t i = lineBegin; i < lineEnd; ++i) {
+                    out = formatLine(i, out, limit);
+                }
+                blockSizes[b] = static_cast<size_t>(out - start);
+            }
+        };
+        if (pool && batch > 1) pool->parallelFor(0, batch, 1, formatBlocks);
+        else formatBlocks(0, batch);
+
+        for (size_t b = 0; b < batch; ++b) {
+            if (std::fwrite(blocks[b].data(), 1, blockSizes[b], file) != blockSizes[b]) return false;
+        }
+    }
+    return true;
+}
+
+// 把文件名转成 glTF 的相对 URI，保留字符以外的字节都做百分号编码
+std::string toUri(const std::string& fileName) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string uri;
+    for (unsigned char c : fileName) {
+        bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '_' || c == '.' || c == '~';
+        if (plain) {
+            uri += static_cast<char>(c);
+        }
+        else {
+            uri += '%';
+            uri += hex[c >> 4];
+            uri += hex[c & 15];
+        }
+    }
+    return uri;
+}
+
+}
+
+namespace MeshExporter {
+
+bool exportOBJ(const TopologyGraph& graph, const std::string& path, ThreadPool* pool) {
+    OutputFile output(path);
+    if (!output.file) return false;
+    FILE* file = output.file;
+
+    const auto& vertices = graph.getVertices();
+    const auto& indices = graph.getIndices();
+
+    std::fprintf(file, "# TopologyGenerator\n");
+    std::fprintf(file, "# vertices %zu, edges %zu\n", vertices.size(), indices.size() / 2);
+
+    // 与 "v %.6f %.6f %.6f" 输出一致
+    bool ok = writeLines(file, vertices.size(), kMaxVertexLineChars, pool, [&](size_t i, char* out, char* end) {
+        const glm::vec3& v = vertices[i];
+        *out++ = 'v';
+        for (int k = 0; k < 3; ++k) {
+            *out++ = ' ';
+            out = appendFloat(out, end, v[k]);
+        }
+        *out++ = '\n';
+        return out;
+    });
+
+    // OBJ 的索引从 1 开始
+    ok = ok && writeLines(file, indices.size() / 2, kMaxEdgeLineChars, pool, [&](size_t i, char* out, char* end) {
+        *out++ = 'l';
+        *out++ = ' ';
+        out = appendUnsigned(out, end, indices[i * 2] + 1);
+        *out++ = ' ';
+        out = appendUnsigned(out, end, indices[i * 2 + 1] + 1);
+        *out++ = '\n';
+        return out;
+    });
+
+    return output.close() && ok;
+}
+
+bool exportPLY(const TopologyGraph& graph, const std::string& path) {
+    OutputFile output(path);
+    if (!output.file) return false;
+    FILE* file = output.file;
+
+    const auto& vertices = graph.getVertices();
+    const auto& indices = graph.getIndices();
+    size_t edgeCount = indices.size() / 2;
+
+    std::fprintf(file,
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "comment TopologyGenerator\n"
+        "element vertex %zu\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element edge %zu\n"
+        "property uint vertex1\n"
+        "property uint vertex2\n"
+        "end_header\n",
+        vertices.size(), edgeCount);
+
+    // 顶点和索引在内存中的布局与 PLY 的记录布局相同，直接整块写出
+    bool ok = writeLittleEndian(file, vertices.data(), vertices.size() * 3, sizeof(float));
+    ok = ok && writeLittleEndian(file, indices.data(), edgeCount * 2, sizeof(unsigned int));
+
+    return output.close() && ok;
+}
+
+bool exportGLTF(const TopologyGraph& graph, const std::string& path) {
+    const auto& vertices = graph.getVertices();
+    bool shortIndices = graph.hasShortIndices();
+    size_t indexCount = graph.getIndexCount() / 2 * 2;
+    size_t indexBytes = shortIndices ? sizeof(uint16_t) : sizeof(unsigned int);
+    const void* indexData = shortIndices
+        ? static_cast<const void*>(graph.getShortIndices().data())
+        : static_cast<const void*>(graph.getIndices().data());
+
+    std::filesystem::path binPath = std::filesystem::path(path).replace_extension(".bin");
+    size_t positionBytes = vertices.size() * sizeof(glm::vec3);
+    size_t totalIndexBytes = indexCount * indexBytes;
+
+    // 先写二进制数据，全部成功后再写 .gltf，避免留下指向不完整数据的文件
+    if (!vertices.empty()) {
+        OutputFile bin(binPath.string());
+        if (!bin.file) return false;
+        bool ok = writeLittleEndian(bin.file, vertices.data(), vertices.size() * 3, sizeof(float));
+        ok = ok && writeLittleEndian(bin.file, indexData, indexCount, indexBytes);
+        if (!bin.close() || !ok) return false;
+    }
+
+    OutputFile output(path);
+    if (!output.file) return false;
+    FILE* file = output.file;
+
+    std::fprintf(file, "{\n  \"asset\": { \"version\": \"2.0\", \"generator\": \"TopologyGenerator\" },\n");
+    std::fprintf(file, "  \"scene\": 0,\n");
+    if (vertices.empty()) {
+        // 空图只写一个没有节点的场景
+        std::fprintf(file, "  \"scenes\": [ { \"nodes\": [] } ]\n}\n");
+        return output.close();
+    }
+
+    // glTF 要求 POSITION 访问器给出包围盒
+    glm::vec3 minimum = vertices.front();
+    glm::vec3 maximum = vertices.front();
+    for (const glm::vec3& v : vertices) {
+        minimum = glm::min(minimum, v);
+        maximum = glm::max(maximum, v);
+    }
+
+    // 没有边时退化为点图元，不写索引访问器
+    bool hasIndices = indexCount > 0;
+    std::fprintf(file, "  \"scenes\": [ { \"nodes\": [ 0 ] } ],\n");
+    std::fprintf(file, "  \"nodes\": [ { \"mesh\": 0 } ],\n");
+    if (hasIndices) {
+        std::fprintf(file, "  \"meshes\": [ { \"primitives\": [ { \"attributes\": { \"POSITION\": 0 }, \"indices\": 1, \"mode\": 1 } ] } ],\n");
+    }
+    else {
+        std::fprintf(file, "  \"meshes\": [ { \"primitives\": [ { \"attributes\": { \"POSITION\": 0 }, \"mode\": 0 } ] } ],\n");
+    }
+    std::fprintf(file, "  \"buffers\": [ { \"uri\": \"%s\", \"byteLength\": %zu } ],\n",
+        toUri(binPath.filename().string()).c_str(), positionBytes + totalIndexBytes);
+
+    // 34962 = ARRAY_BUFFER，34963 = ELEMENT_ARRAY_BUFFER
+    std::fprintf(file, "  \"bufferViews\": [\n");
+    std::fprintf(file, "    { \"buffer\": 0, \"byteOffset\": 0, \"byteLength\": %zu, \"target\": 34962 }%s\n",
+        positionBytes, hasIndices ? "," : "");
+    if (hasIndices) {
+        std::fprintf(file, "    { \"buffer\": 0, \"byteOffset\": %zu, \"byteLength\": %zu, \"target\": 34963 }\n",
+            positionBytes, totalIndexBytes);
+    }
+    std::fprintf(file, "  ],\n");
+
+    // 5126 = FLOAT，5123 = UNSIGNED_SHORT，5125 = UNSIGNED_INT
+    std::fprintf(file, "  \"accessors\": [\n");
+    std::fprintf(file, "    { \"bufferView\": 0, \"componentType\": 5126, \"count\": %zu, \"type\": \"VEC3\", "
+        "\"min\": [ %.9g, %.9g, %.9g ], \"max\": [ %.9g, %.9g, %.9g ] }%s\n",
+        vertices.size(), minimum.x, minimum.y, minimum.z, maximum.x, maximum.y, maximum.z, hasIndices ? "," : "");
+    if (hasIndices) {
+        std::fprintf(file, "    { \"bufferView\": 1, \"componentType\": %d, \"count\": %zu, \"type\": \"SCALAR\" }\n",
+            shortIndices ? 5123 : 5125, indexCount);
+    }
+    std::fprintf(file, "  ]\n}\n");
+
+    return output.close();
+}
+
+bool exportMesh(const TopologyGraph& graph, const std::string& path, Format format, ThreadPool* pool) {
+    switch (format) {
+    case Format::PLY:
+        return exportPLY(graph, path);
+    case Format::GLTF:
+        return exportGLTF(graph, path);
+    default:
+        return exportOBJ(graph, path, pool);
+    }
+}
+
+const char* getExtension(Format format) {
+    switch (format) {
+    case Format::PLY:
+        return ".ply";
+    case Format::GLTF:
+        return ".gltf";
+    default:
+        return ".obj";
+    }
+}
+
+}
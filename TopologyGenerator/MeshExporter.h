@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 缃戞牸瀵煎嚭锛屼笉渚濊禆浠讳綍鍥惧舰搴擄紝鎵归噺鐢熸垚宸ュ叿鍜屼富绋嬪簭閮藉彲浠ヤ娇鐢#pragma once
+#include <string>
+#include "TopologyGraph.h"
+
+class ThreadPool;
+
+// 网格导出，不依赖任何图形库，批量生成工具和主程序都可以使用
+// 所有格式都按固定大小的块边整理边写出，除了一个块大小的暂存区外不会再复制一份网格，
+// 导出上亿条边的图时内存占用也不会翻倍
+namespace MeshExporter {
+    enum class Format { OBJ, PLY, GLTF };
+
+    // 导出为 OBJ 文件，边以 "l a b" 的线段形式写出
+    // 传入线程池时多个块并行格式化，再按顺序写出，文本格式化不再成为瓶颈
+    bool exportOBJ(const TopologyGraph& graph, const std::string& path, ThreadPool* pool = nullptr);
+
+    // 导出为 binary_little_endian 的 PLY 文件，包含 vertex (float x y z) 和 edge (uint vertex1 vertex2) 两个元素
+    bool exportPLY(const TopologyGraph& graph, const std::string& path);
+
+    // 导出为 glTF 2.0，path 为 .gltf 文件，二进制数据写到同名的 .bin 文件
+    // 图元模式为 LINES，图使用 16 位索引时索引也按 16 位写出
+    bool exportGLTF(const TopologyGraph& graph, const std::string& path);
+
+    // 按格式分派到上面的函数
+    bool exportMesh(const TopologyGraph& graph, const std::string& path, Format format, ThreadPool* pool = nullptr);
+
+    // 格式对应的文件扩展名，包含点号
+    const char* getExtension(Format format);
+}
@@ -0,0 +1,324 @@
+#include "OffscreenRenderer.h"
+#include "ProceduralShader.h"
+#include <EGL/eglext.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+void* loadProc(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+    size_t length = std::strlen(name);
+    for (const char* found = std::strstr(extensions, name); found; found = std::strstr(found + length, name)) {
+        // 蹇呴』鏄#include "OffscreenRenderer.h"
+#include "ProceduralShader.h"
+#include <EGL/eglext.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+void* loadProc(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+    size_t length = std::strlen(name);
+    for (const char* found = std::strstr(extensions, name); found; found = std::strstr(found + length, name)) {
+        // 必须是完整的扩展名，不能只是另一个扩展名的前缀
+        bool starts = found == extensions || found[-1] == ' ';
+        bool ends = found[length] == ' ' || found[length] == '\0';
+        if (starts && ends) return true;
+    }
+    return false;
+}
+
+// 编译链接失败时把驱动给出的信息带到异常里
+GLuint linkProgram(const char* vertexSrc, const char* fragmentSrc) {
+    unsigned int vShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vShader, 1, &vertexSrc, NULL);
+    glCompileShader(vShader);
+
+    unsigned int fShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fShader, 1, &fragmentSrc, NULL);
+    glCompileShader(fShader);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vShader);
+    glAttachShader(program, fShader);
+    glLinkProgram(program);
+
+    glDeleteShader(vShader);
+    glDeleteShader(fShader);
+
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char info[1024];
+        glGetProgramInfoLog(program, sizeof(info), NULL, info);
+        glDeleteProgram(program);
+        throw std::runtime_error(std::string("Failed to link shader program: ") + info);
+    }
+    return program;
+}
+
+}
+
+OffscreenRenderer::~OffscreenRenderer() {
+    destroy();
+}
+
+void OffscreenRenderer::init(int width, int height, int samples) {
+    if (width <= 0 || height <= 0) throw std::runtime_error("Invalid offscreen size");
+    m_width = width;
+    m_height = height;
+
+    createContext();
+    if (!gladLoadGLLoader(loadProc)) {
+        throw std::runtime_error("Failed to initialize GLAD");
+    }
+    createTargets(samples);
+    createPrograms();
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_ebo);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glGenVertexArrays(1, &m_proceduralVao);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_MULTISAMPLE);
+}
+
+void OffscreenRenderer::createContext() {
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    auto try_display = [this](EGLDisplay display) {
+        if (display == EGL_NO_DISPLAY) return false;
+        EGLint major = 0, minor = 0;
+        if (!eglInitialize(display, &major, &minor)) return false;
+        m_display = display;
+        return true;
+    };
+
+    // 没有 X 的服务器上，NVIDIA 等驱动只能通过设备平台访问 GPU；Mesa 的设备列表中软件渲染排在最后
+    if (get_platform_display && hasExtension(client_extensions, "EGL_EXT_platform_device")) {
+        PFNEGLQUERYDEVICESEXTPROC query_devices =
+            reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+        EGLDeviceEXT device = nullptr;
+        EGLint device_count = 0;
+        if (query_devices && query_devices(1, &device, &device_count) && device_count > 0) {
+            try_display(get_platform_display(EGL_PLATFORM_DEVICE_EXT, device, nullptr));
+        }
+    }
+    if (m_display == EGL_NO_DISPLAY && get_platform_display && hasExtension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+        try_display(get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr));
+    }
+    if (m_display == EGL_NO_DISPLAY && !try_display(eglGetDisplay(EGL_DEFAULT_DISPLAY))) {
+        throw std::runtime_error("Failed to initialize EGL display");
+    }
+
+    // 不创建任何表面，只渲染到帧缓冲区对象，需要 EGL_KHR_surfaceless_context
+    const char* display_extensions = eglQueryString(m_display, EGL_EXTENSIONS);
+    if (!hasExtension(display_extensions, "EGL_KHR_surfaceless_context")) {
+        throw std::runtime_error("EGL display does not support surfaceless contexts");
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        throw std::runtime_error("EGL does not support desktop OpenGL");
+    }
+
+    const EGLint config_attributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config = nullptr;
+    EGLint config_count = 0;
+    eglChooseConfig(m_display, config_attributes, &config, 1, &config_count);
+    if (config_count == 0) {
+        // 无表面平台可能不提供任何配置，这时需要 EGL_KHR_no_config_context
+        if (!hasExtension(display_extensions, "EGL_KHR_no_config_context")) {
+            throw std::runtime_error("No EGL config supports OpenGL");
+        }
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, context_attributes);
+    if (m_context == EGL_NO_CONTEXT) {
+        throw std::runtime_error("Failed to create OpenGL 3.3 core context");
+    }
+    if (!eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context)) {
+        throw std::runtime_error("Failed to make EGL context current");
+    }
+}
+
+void OffscreenRenderer::createTargets(int samples) {
+    GLint max_samples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    samples = std::max(0, std::min(samples, static_cast<int>(max_samples)));
+
+    glGenFramebuffers(1, &m_fbo);
+    glGenRenderbuffers(1, &m_colorBuffer);
+    glGenRenderbuffers(1, &m_depthBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, m_width, m_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, m_width, m_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glGenFramebuffers(1, &m_resolveFbo);
+    glGenRenderbuffers(1, &m_resolveBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_resolveFbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_resolveBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_resolveBuffer);
+    complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        throw std::runtime_error("Failed to create offscreen framebuffer of " +
+            std::to_string(m_width) + "x" + std::to_string(m_height));
+    }
+}
+
+void OffscreenRenderer::createPrograms() {
+    const char* vShaderSrc = R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+        uniform mat4 mvp;
+        void main() {
+            gl_Position = mvp * vec4(aPos, 1.0);
+        }
+    )";
+    const char* fShaderSrc = R"(
+        #version 330 core
+        out vec4 FragColor;
+        uniform vec3 objectColor;
+        void main() {
+            FragColor = vec4(objectColor, 1.0f);
+        }
+    )";
+
+    m_program = linkProgram(vShaderSrc, fShaderSrc);
+    m_proceduralProgram = linkProgram(kProceduralVertexShader, fShaderSrc);
+}
+
+void OffscreenRenderer::upload(const TopologyGraph& graph) {
+    ArrayView<glm::vec3> vertices = graph.getVertices();
+    ArrayView<unsigned int> indices = graph.getIndices();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // 索引缓冲区绑定在 VAO 上
+    glBindVertexArray(m_vao);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    m_vertexCount = static_cast<GLsizei>(vertices.size());
+    m_indexCount = static_cast<GLsizei>(indices.size());
+    m_procedural = false;
+}
+
+bool OffscreenRenderer::setProcedural(const Parameters& params) {
+    if (!supportsProceduralShape(params)) return false;
+    MeshSize size = TopologyGraph::computeSize(params);
+    m_vertexCount = static_cast<GLsizei>(size.vertexCount);
+    m_indexCount = static_cast<GLsizei>(size.indexCount);
+    m_proceduralParams = params;
+    m_procedural = true;
+    return true;
+}
+
+void OffscreenRenderer::render(const glm::mat4& view, const glm::mat4& proj, const glm::mat4& model) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_width, m_height);
+    glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    GLuint program = m_procedural ? m_proceduralProgram : m_program;
+    glUseProgram(program);
+    glm::mat4 mvp = proj * view * model;
+    glUniformMatrix4fv(glGetUniformLocation(program, "mvp"), 1, GL_FALSE, glm::value_ptr(mvp));
+    if (m_procedural) setProceduralShapeUniforms(program, m_proceduralParams);
+    glBindVertexArray(m_procedural ? m_proceduralVao : m_vao);
+
+    // 绘制边：程序化模式下每条边两个顶点，由 gl_VertexID 算出端点
+    glUniform3f(glGetUniformLocation(program, "objectColor"), 0.7f, 0.7f, 0.7f);
+    if (m_procedural) {
+        glUniform1i(glGetUniformLocation(program, "drawLines"), 1);
+        glDrawArrays(GL_LINES, 0, m_indexCount);
+        glUniform1i(glGetUniformLocation(program, "drawLines"), 0);
+    }
+    else {
+        glDrawElements(GL_LINES, m_indexCount, GL_UNSIGNED_INT, (void*)0);
+    }
+
+    // 绘制节点
+    glUniform3f(glGetUniformLocation(program, "objectColor"), 0.2f, 0.8f, 0.8f);
+    glPointSize(5.0f);
+    glDrawArrays(GL_POINTS, 0, m_vertexCount);
+    glBindVertexArray(0);
+
+    // 解析多重采样，之后的读取都从解析结果中进行
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolveFbo);
+    glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_resolveFbo);
+}
+
+void OffscreenRenderer::destroy() {
+    if (m_context == EGL_NO_CONTEXT) {
+        if (m_display != EGL_NO_DISPLAY) eglTerminate(m_display);
+        m_display = EGL_NO_DISPLAY;
+        return;
+    }
+
+    if (m_program) {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ebo);
+        glDeleteProgram(m_program);
+        glDeleteVertexArrays(1, &m_proceduralVao);
+        glDeleteProgram(m_proceduralProgram);
+        glDeleteFramebuffers(1, &m_fbo);
+        glDeleteRenderbuffers(1, &m_colorBuffer);
+        glDeleteRenderbuffers(1, &m_depthBuffer);
+        glDeleteFramebuffers(1, &m_resolveFbo);
+        glDeleteRenderbuffers(1, &m_resolveBuffer);
+    }
+    m_program = m_vao = m_vbo = m_ebo = 0;
+    m_proceduralProgram = m_proceduralVao = 0;
+    m_procedural = false;
+    m_fbo = m_colorBuffer = m_depthBuffer = m_resolveFbo = m_resolveBuffer = 0;
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(m_display, m_context);
+    eglTerminate(m_display);
+    m_context = EGL_NO_CONTEXT;
+    m_display = EGL_NO_DISPLAY;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <EGL/egl.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+// 涓嶉渶瑕佺獥鍙ｇ殑绂诲睆娓叉煋鍣#pragma once
+#include <EGL/egl.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+
+// 不需要窗口的离屏渲染器：用 EGL 创建不带默认帧缓冲区的 OpenGL 3.3 核心上下文，画面渲染到多重采样的帧缓冲区对象
+// 只在 Linux 上构建，用于在没有显示器的服务器上批量出图；着色器和配色与 Application 的缓冲区模式和 GPU 程序化模式相同
+class OffscreenRenderer {
+public:
+    OffscreenRenderer() = default;
+    ~OffscreenRenderer();
+    OffscreenRenderer(const OffscreenRenderer&) = delete;
+    OffscreenRenderer& operator=(const OffscreenRenderer&) = delete;
+
+    // 创建上下文、着色器和 width x height 的渲染目标，失败时抛出 std::runtime_error
+    void init(int width, int height, int samples);
+    void destroy();
+
+    // 上传 32 位浮点坐标和 32 位索引，替换之前的图形
+    void upload(const TopologyGraph& graph);
+    // 改为 GPU 程序化绘制：不上传数据，顶点由着色器按 gl_VertexID 算出（和 Application 的 GPU procedural 模式共用着色器）
+    // 参数不满足 supportsProceduralShape 时返回 false，之前的图形不变；之后调用 upload 恢复缓冲区绘制
+    bool setProcedural(const Parameters& params);
+    // 渲染一帧；结束时多重采样已经解析，结果绑定为读帧缓冲区，可以直接用 glReadPixels 或 ScreenCapture 读取
+    void render(const glm::mat4& view, const glm::mat4& proj, const glm::mat4& model);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+private:
+    EGLDisplay m_display = EGL_NO_DISPLAY;
+    EGLContext m_context = EGL_NO_CONTEXT;
+
+    int m_width = 0;
+    int m_height = 0;
+    // 多重采样的渲染目标，以及解析后用来读取像素的目标
+    GLuint m_fbo = 0, m_colorBuffer = 0, m_depthBuffer = 0;
+    GLuint m_resolveFbo = 0, m_resolveBuffer = 0;
+
+    GLuint m_program = 0;
+    GLuint m_vao = 0, m_vbo = 0, m_ebo = 0;
+    GLsizei m_vertexCount = 0;
+    GLsizei m_indexCount = 0;
+
+    // 程序化绘制不读取顶点属性，但核心模式下绘制时必须绑定一个 VAO
+    GLuint m_proceduralProgram = 0;
+    GLuint m_proceduralVao = 0;
+    bool m_procedural = false;
+    Parameters m_proceduralParams;
+
+    // 依次尝试 GPU 设备、Mesa 的无表面平台和默认显示，把上下文设为当前上下文
+    void createContext();
+    void createTargets(int samples);
+    void createPrograms();
+};
@@ -0,0 +1,261 @@
+// PngStreamWriter 鐨勫線杩旀// PngStreamWriter 的往返检查：写出若干测试图，再用 zlib 解压 IDAT、按 PNG 规则反滤波，逐像素和输入比较
+// 覆盖 1x1、RGB 和 RGBA、宽度不是分块大小整数倍的图，以及压缩数据分成多个 IDAT 块的图；全部通过时返回 0
+#include "PngStreamWriter.h"
+
+#include <zlib.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <iterator>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+
+// ScreenCapture 一块最大的边长，宽度取它加上一个零头，保证跨块的行也被检查
+const uint32_t kTileSize = 2048;
+
+struct DecodedPng {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int channels = 0;
+    size_t idatChunks = 0;
+    // 每种滤波类型出现的行数
+    size_t filterCounts[5] = {};
+    std::vector<unsigned char> pixels;
+};
+
+uint32_t loadBigEndian(const unsigned char* data) {
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+int paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+bool decodePng(const std::string& path, DecodedPng& png, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    if (data.size() < 8 || std::memcmp(data.data(), signature, 8) != 0) {
+        error = "bad signature";
+        return false;
+    }
+
+    // 逐块解析并校验 CRC，收集全部 IDAT 数据
+    std::vector<unsigned char> compressed;
+    bool seen_header = false;
+    bool seen_end = false;
+    size_t offset = 8;
+    while (offset + 12 <= data.size() && !seen_end) {
+        uint32_t length = loadBigEndian(&data[offset]);
+        if (offset + 12 + length > data.size()) break;
+        const unsigned char* type = &data[offset + 4];
+        const unsigned char* body = type + 4;
+        uint32_t crc = static_cast<uint32_t>(crc32(0, type, length + 4));
+        if (crc != loadBigEndian(body + length)) {
+            error = "CRC mismatch in " + std::string(reinterpret_cast<const char*>(type), 4);
+            return false;
+        }
+        if (std::memcmp(type, "IHDR", 4) == 0 && length == 13) {
+            png.width = loadBigEndian(body);
+            png.height = loadBigEndian(body + 4);
+            if (body[8] != 8 || (body[9] != 2 && body[9] != 6) || body[10] != 0 || body[11] != 0 || body[12] != 0) {
+                error = "unexpected IHDR fields";
+                return false;
+            }
+            png.channels = body[9] == 6 ? 4 : 3;
+            seen_header = true;
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), body, body + length);
+            ++png.idatChunks;
+        }
+        else if (std::memcmp(type, "IEND", 4) == 0) {
+            seen_end = true;
+        }
+        offset += 12 + length;
+    }
+    if (!seen_header || !seen_end || png.idatChunks == 0) {
+        error = "missing IHDR, IDAT or IEND";
+        return false;
+    }
+
+    // 解压后的大小是确定的：每行一个滤波类型字节加一行像素；多出数据或流没有正常结束都算错
+    size_t row_bytes = static_cast<size_t>(png.width) * png.channels;
+    std::vector<unsigned char> raw(png.height * (row_bytes + 1) + 1);
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        error = "inflateInit failed";
+        return false;
+    }
+    stream.next_in = compressed.data();
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = raw.data();
+    stream.avail_out = static_cast<uInt>(raw.size());
+    int status = inflate(&stream, Z_FINISH);
+    size_t produced = stream.total_out;
+    size_t unused = stream.avail_in;
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END || produced != raw.size() - 1 || unused != 0) {
+        error = "inflate failed: status " + std::to_string(status) + ", " + std::to_string(produced) + " bytes";
+        return false;
+    }
+
+    png.pixels.assign(png.height * row_bytes, 0);
+    std::vector<unsigned char> zero_row(row_bytes, 0);
+    size_t bpp = static_cast<size_t>(png.channels);
+    for (uint32_t y = 0; y < png.height; ++y) {
+        const unsigned char* in = &raw[y * (row_bytes + 1)];
+        unsigned char filter = in[0];
+        ++in;
+        unsigned char* out = &png.pixels[y * row_bytes];
+        const unsigned char* up = y > 0 ? out - row_bytes : zero_row.data();
+        if (filter > 4) {
+            error = "invalid filter type " + std::to_string(filter) + " on row " + std::to_string(y);
+            return false;
+        }
+        ++png.filterCounts[filter];
+        for (size_t i = 0; i < row_bytes; ++i) {
+            int a = i >= bpp ? out[i - bpp] : 0;
+            int b = up[i];
+            int c = i >= bpp ? up[i - bpp] : 0;
+            int predicted = 0;
+            switch (filter) {
+            case 1: predicted = a; break;
+            case 2: predicted = b; break;
+            case 3: predicted = (a + b) / 2; break;
+            case 4: predicted = paethPredictor(a, b, c); break;
+            default: break;
+            }
+            out[i] = static_cast<unsigned char>(in[i] + predicted);
+        }
+    }
+    return true;
+}
+
+struct Case {
+    const char* name;
+    uint32_t width;
+    uint32_t height;
+    int channels;
+    // 生成 (x, y) 处第 channel 个通道的值
+    std::function<unsigned char(uint32_t x, uint32_t y, int channel)> pixel;
+    bool expectMultipleChunks;
+};
+
+bool runCase(const Case& test, const std::string& path) {
+    size_t row_bytes = static_cast<size_t>(test.width) * test.channels;
+    std::vector<unsigned char> image(row_bytes * test.height);
+    for (uint32_t y = 0; y < test.height; ++y) {
+        for (uint32_t x = 0; x < test.width; ++x) {
+            for (int c = 0; c < test.channels; ++c) {
+                image[y * row_bytes + x * test.channels + c] = test.pixel(x, y, c);
+            }
+        }
+    }
+
+    PngStreamWriter writer;
+    bool written = writer.open(path, test.width, test.height, test.channels);
+    for (uint32_t y = 0; written && y < test.height; ++y) written = writer.writeRow(&image[y * row_bytes]);
+    written = writer.close() && written;
+
+    DecodedPng png;
+    std::string error;
+    bool ok = written && decodePng(path, png, error);
+    if (!written) error = "writer failed";
+    if (ok && (png.width != test.width || png.height != test.height || png.channels != test.channels)) {
+        error = "header does not match the input";
+        ok = false;
+    }
+    if (ok && test.expectMultipleChunks && png.idatChunks < 2) {
+        error = "expected more than one IDAT chunk";
+        ok = false;
+    }
+    if (ok) {
+        for (size_t i = 0; i < image.size(); ++i) {
+            if (png.pixels[i] == image[i]) continue;
+            size_t y = i / row_bytes;
+            size_t x = (i % row_bytes) / test.channels;
+            error = "pixel (" + std::to_string(x) + ", " + std::to_string(y) + ") channel " +
+                std::to_string(i % test.channels) + ": expected " + std::to_string(image[i]) +
+                ", got " + std::to_string(png.pixels[i]);
+            ok = false;
+            break;
+        }
+    }
+    std::remove(path.c_str());
+
+    std::cout << (ok ? "PASS " : "FAIL ") << test.name << " (" << test.width << "x" << test.height
+        << ", " << test.channels << " channels";
+    if (png.idatChunks > 0) {
+        std::cout << ", " << png.idatChunks << " IDAT, filters";
+        for (size_t count : png.filterCounts) std::cout << " " << count;
+    }
+    std::cout << ")";
+    if (!ok) std::cout << ": " << error;
+    std::cout << "\n";
+    return ok;
+}
+
+// 固定种子的伪随机数，压缩不了的噪声保证压缩数据超过一个 IDAT 块
+unsigned char noise(uint32_t x, uint32_t y, int channel) {
+    uint32_t value = x * 73856093u ^ y * 19349663u ^ static_cast<uint32_t>(channel) * 83492791u;
+    value ^= value >> 13;
+    value *= 0x5BD1E995u;
+    value ^= value >> 15;
+    return static_cast<unsigned char>(value);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "png_check.png";
+
+    const std::vector<Case> cases = {
+        { "single pixel RGB", 1, 1, 3, [](uint32_t, uint32_t, int c) { return static_cast<unsigned char>(40 + c * 90); }, false },
+        { "single pixel RGBA", 1, 1, 4, [](uint32_t, uint32_t, int c) { return static_cast<unsigned char>(250 - c * 60); }, false },
+        // 横竖两个方向都有斜率的渐变只有 Paeth 能预测准，Sub 和 Up 各自只适合一个方向
+        { "diagonal gradient RGB", 257, 64, 3,
+            [](uint32_t x, uint32_t y, int c) { return static_cast<unsigned char>(x * 3 + y * 5 + c * 17); }, false },
+        { "horizontal stripes RGBA", 131, 40, 4,
+            [](uint32_t x, uint32_t y, int c) { return static_cast<unsigned char>((y / 4) * 37 + c * 50 + (x > 64 ? 9 : 0)); }, false },
+        // 噪声、渐变和平坦区域交替，四种滤波都会被选中
+        { "mixed content RGBA wider than a tile", kTileSize + 37, 96, 4,
+            [](uint32_t x, uint32_t y, int c) {
+                switch ((y / 8) % 4) {
+                case 0: return noise(x, y, c);
+                case 1: return static_cast<unsigned char>(x * 2 + y * 7 + c);
+                case 2: return static_cast<unsigned char>(x + c * 40);
+                default: return static_cast<unsigned char>(x < kTileSize ? 200 : 30);
+                }
+            }, true },
+        { "noise RGB wider than a tile", kTileSize + 5, 40, 3, noise, true },
+    };
+
+    int failures = 0;
+    for (const Case& test : cases) {
+        if (!runCase(test, path)) ++failures;
+    }
+
+    // 行数不够就结束必须报错
+    PngStreamWriter writer;
+    std::vector<unsigned char> row(3 * 4, 128);
+    bool incomplete_ok = writer.open(path, 4, 2, 3) && writer.writeRow(row.data()) && !writer.close();
+    std::remove(path.c_str());
+    std::cout << (incomplete_ok ? "PASS " : "FAIL ") << "close reports missing rows\n";
+    if (!incomplete_ok) ++failures;
+
+    if (failures > 0) std::cout << failures << " check(s) failed\n";
+    return failures == 0 ? 0 : 1;
+}
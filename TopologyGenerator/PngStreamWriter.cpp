@@ -0,0 +1,357 @@
+#include "PngStreamWriter.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+// deflate 鐨勭獥鍙ｅぇ灏忓拰鍖归厤闀垮害鑼冨洿
+const size_t kWindowSize = 32768;
+const size_t kMinMatch = 3;
+const size_t kMaxMatch = 258;
+// 娌垮搱甯岄摼鏈€澶氭瘮杈冪殑鍊欓€変綅缃#include "PngStreamWriter.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+// deflate 的窗口大小和匹配长度范围
+const size_t kWindowSize = 32768;
+const size_t kMinMatch = 3;
+const size_t kMaxMatch = 258;
+// 沿哈希链最多比较的候选位置数，越大压缩率越高、速度越慢
+const int kMaxChain = 32;
+const int kHashBits = 15;
+// 攒够这么多压缩数据再写一个 IDAT 块
+const size_t kChunkSize = 65536;
+
+// 长度码 257..285 和距离码 0..29 的基数与额外位数
+const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+const std::array<uint32_t, 256>& crcTable() {
+    // 局部静态变量的初始化是线程安全的，多个编码线程可以同时使用
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> values{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            values[n] = c;
+        }
+        return values;
+    }();
+    return table;
+}
+
+// 固定哈夫曼码表（RFC 1951 3.2.6），码字已按位反转，可以直接从低位写入
+struct FixedCode {
+    uint16_t bits;
+    uint8_t length;
+};
+
+uint16_t reverseBits(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; ++i) reversed |= ((code >> i) & 1u) << (length - 1 - i);
+    return static_cast<uint16_t>(reversed);
+}
+
+const std::array<FixedCode, 288>& literalCodes() {
+    static const std::array<FixedCode, 288> table = []() {
+        std::array<FixedCode, 288> codes{};
+        for (int symbol = 0; symbol < 288; ++symbol) {
+            uint32_t code;
+            int length;
+            if (symbol <= 143) { code = 0x30 + symbol; length = 8; }
+            else if (symbol <= 255) { code = 0x190 + symbol - 144; length = 9; }
+            else if (symbol <= 279) { code = symbol - 256; length = 7; }
+            else { code = 0xC0 + symbol - 280; length = 8; }
+            codes[symbol] = { reverseBits(code, length), static_cast<uint8_t>(length) };
+        }
+        return codes;
+    }();
+    return table;
+}
+
+uint32_t updateCrc(uint32_t crc, const unsigned char* data, size_t size) {
+    const std::array<uint32_t, 256>& table = crcTable();
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+void storeBigEndian(unsigned char* out, uint32_t value) {
+    out[0] = static_cast<unsigned char>(value >> 24);
+    out[1] = static_cast<unsigned char>(value >> 16);
+    out[2] = static_cast<unsigned char>(value >> 8);
+    out[3] = static_cast<unsigned char>(value);
+}
+
+int paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+uint32_t hash3(const unsigned char* data) {
+    uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+    return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+}
+
+PngStreamWriter::~PngStreamWriter() {
+    if (m_file) std::fclose(m_file);
+}
+
+bool PngStreamWriter::open(const std::string& path, uint32_t width, uint32_t height, int channels) {
+    if (m_file || width == 0 || height == 0 || (channels != 3 && channels != 4)) return false;
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) return false;
+
+    m_ok = true;
+    m_width = width;
+    m_height = height;
+    m_channels = channels;
+    m_rowBytes = static_cast<size_t>(width) * channels;
+    m_rowsWritten = 0;
+    m_previousRow.assign(m_rowBytes, 0);
+    for (std::vector<unsigned char>& filtered : m_filtered) filtered.resize(m_rowBytes + 1);
+    m_window.clear();
+    m_windowStart = 0;
+    m_encoded = 0;
+    m_hashHead.assign(size_t(1) << kHashBits, 0);
+    m_hashPrevious.assign(kWindowSize, 0);
+    m_bitBuffer = 0;
+    m_bitCount = 0;
+    m_pending.clear();
+    m_adlerA = 1;
+    m_adlerB = 0;
+
+    const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    writeBytes(signature, sizeof(signature));
+    unsigned char header[13];
+    storeBigEndian(header, width);
+    storeBigEndian(header + 4, height);
+    header[8] = 8;
+    // 颜色类型 2 为 RGB，6 为 RGBA
+    header[9] = channels == 4 ? 6 : 2;
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    writeChunk("IHDR", header, sizeof(header));
+
+    // zlib 头（32 KB 窗口，无预设字典），整个图像只用一个固定哈夫曼块
+    m_pending.push_back(0x78);
+    m_pending.push_back(0x01);
+    writeBits(1, 1);
+    writeBits(1, 2);
+    return m_ok;
+}
+
+bool PngStreamWriter::writeRow(const unsigned char* row) {
+    if (!m_file || m_rowsWritten >= m_height) return false;
+
+    // 四种滤波都算一遍，取绝对值和最小的（和 libpng 的默认启发式相同）
+    const unsigned char* up = m_previousRow.data();
+    size_t bpp = static_cast<size_t>(m_channels);
+    unsigned char* none = m_filtered[0].data() + 1;
+    unsigned char* sub = m_filtered[1].data() + 1;
+    unsigned char* vertical = m_filtered[2].data() + 1;
+    unsigned char* paeth = m_filtered[3].data() + 1;
+    for (size_t i = 0; i < bpp; ++i) {
+        none[i] = row[i];
+        sub[i] = row[i];
+        vertical[i] = static_cast<unsigned char>(row[i] - up[i]);
+        paeth[i] = static_cast<unsigned char>(row[i] - up[i]);
+    }
+    for (size_t i = bpp; i < m_rowBytes; ++i) {
+        none[i] = row[i];
+        sub[i] = static_cast<unsigned char>(row[i] - row[i - bpp]);
+        vertical[i] = static_cast<unsigned char>(row[i] - up[i]);
+        paeth[i] = static_cast<unsigned char>(row[i] - paethPredictor(row[i - bpp], up[i], up[i - bpp]));
+    }
+
+    // 四个槽位对应的 PNG 滤波类型，Paeth 是 4（3 是这里没有用到的 Average）
+    const unsigned char kFilterType[4] = { 0, 1, 2, 4 };
+    size_t best = 0;
+    uint64_t best_sum = UINT64_MAX;
+    for (size_t type = 0; type < 4; ++type) {
+        unsigned char* out = m_filtered[type].data();
+        out[0] = kFilterType[type];
+        uint64_t sum = 0;
+        // 按有符号数计算绝对值
+        for (size_t i = 1; i <= m_rowBytes; ++i) sum += out[i] < 128 ? out[i] : 256 - out[i];
+        if (sum < best_sum) {
+            best_sum = sum;
+            best = type;
+        }
+    }
+
+    appendData(m_filtered[best].data(), m_rowBytes + 1);
+    std::memcpy(m_previousRow.data(), row, m_rowBytes);
+    ++m_rowsWritten;
+    compress(false);
+    flushPending(false);
+    return m_ok;
+}
+
+bool PngStreamWriter::close() {
+    if (!m_file) return false;
+    bool complete = m_rowsWritten == m_height;
+
+    compress(true);
+    // 块结束符，补齐到整字节后写 Adler-32 校验
+    writeLiteral(256);
+    if (m_bitCount > 0) writeBits(0, 8 - m_bitCount);
+    unsigned char adler[4];
+    storeBigEndian(adler, (m_adlerB << 16) | m_adlerA);
+    m_pending.insert(m_pending.end(), adler, adler + 4);
+    flushPending(true);
+    writeChunk("IEND", nullptr, 0);
+
+    if (std::fclose(m_file) != 0) m_ok = false;
+    m_file = nullptr;
+    m_window.clear();
+    m_window.shrink_to_fit();
+    return m_ok && complete;
+}
+
+void PngStreamWriter::appendData(const unsigned char* data, size_t size) {
+    // Adler-32 按 5552 字节一段取模，保证中间结果不溢出
+    size_t offset = 0;
+    while (offset < size) {
+        size_t block = std::min<size_t>(size - offset, 5552);
+        for (size_t i = 0; i < block; ++i) {
+            m_adlerA += data[offset + i];
+            m_adlerB += m_adlerA;
+        }
+        m_adlerA %= 65521;
+        m_adlerB %= 65521;
+        offset += block;
+    }
+
+    // 丢掉已经移出窗口的数据，窗口里只需保留最近 32 KB 已编码的数据
+    size_t keep_from = m_encoded > kWindowSize ? m_encoded - kWindowSize : 0;
+    if (keep_from > m_windowStart + kWindowSize) {
+        m_window.erase(m_window.begin(), m_window.begin() + (keep_from - m_windowStart));
+        m_windowStart = keep_from;
+    }
+    m_window.insert(m_window.end(), data, data + size);
+}
+
+void PngStreamWriter::insertHash(size_t position) {
+    uint32_t hash = hash3(&m_window[position - m_windowStart]);
+    m_hashPrevious[position % kWindowSize] = m_hashHead[hash];
+    m_hashHead[hash] = position + 1;
+}
+
+void PngStreamWriter::compress(bool finish) {
+    size_t end = m_windowStart + m_window.size();
+    while (m_encoded < end) {
+        size_t available = end - m_encoded;
+        if (!finish && available < kMaxMatch) break;
+
+        size_t best_length = 0;
+        size_t best_distance = 0;
+        if (available >= kMinMatch) {
+            const unsigned char* current = &m_window[m_encoded - m_windowStart];
+            size_t max_length = std::min(available, kMaxMatch);
+            size_t candidate = m_hashHead[hash3(current)];
+            // 链上的位置严格递减，超出窗口或者链被新位置覆盖时停止
+            for (int chain = 0; chain < kMaxChain && candidate != 0; ++chain) {
+                size_t position = candidate - 1;
+                if (position >= m_encoded || m_encoded - position > kWindowSize || position < m_windowStart) break;
+                const unsigned char* match = &m_window[position - m_windowStart];
+                size_t length = 0;
+                while (length < max_length && match[length] == current[length]) ++length;
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = m_encoded - position;
+                    if (length == max_length) break;
+                }
+                size_t next = m_hashPrevious[position % kWindowSize];
+                if (next >= candidate) break;
+                candidate = next;
+            }
+        }
+
+        if (best_length >= kMinMatch) {
+            writeMatch(best_length, best_distance);
+            // 匹配覆盖的每个位置都加入哈希链，后面的数据才能引用它们
+            for (size_t i = 0; i < best_length; ++i) {
+                if (end - (m_encoded + i) >= kMinMatch) insertHash(m_encoded + i);
+            }
+            m_encoded += best_length;
+        }
+        else {
+            writeLiteral(m_window[m_encoded - m_windowStart]);
+            if (available >= kMinMatch) insertHash(m_encoded);
+            ++m_encoded;
+        }
+    }
+}
+
+void PngStreamWriter::writeBits(uint32_t value, int count) {
+    m_bitBuffer |= value << m_bitCount;
+    m_bitCount += count;
+    while (m_bitCount >= 8) {
+        m_pending.push_back(static_cast<unsigned char>(m_bitBuffer));
+        m_bitBuffer >>= 8;
+        m_bitCount -= 8;
+    }
+}
+
+void PngStreamWriter::writeLiteral(int symbol) {
+    const FixedCode& code = literalCodes()[symbol];
+    writeBits(code.bits, code.length);
+}
+
+void PngStreamWriter::writeMatch(size_t length, size_t distance) {
+    int code = 28;
+    while (kLengthBase[code] > length) --code;
+    writeLiteral(257 + code);
+    writeBits(static_cast<uint32_t>(length - kLengthBase[code]), kLengthExtra[code]);
+
+    code = 29;
+    while (kDistanceBase[code] > distance) --code;
+    // 距离码固定为 5 位
+    writeBits(reverseBits(code, 5), 5);
+    writeBits(static_cast<uint32_t>(distance - kDistanceBase[code]), kDistanceExtra[code]);
+}
+
+void PngStreamWriter::flushPending(bool force) {
+    while (m_pending.size() >= kChunkSize || (force && !m_pending.empty())) {
+        size_t size = std::min(m_pending.size(), kChunkSize);
+        writeChunk("IDAT", m_pending.data(), size);
+        m_pending.erase(m_pending.begin(), m_pending.begin() + size);
+    }
+}
+
+void PngStreamWriter::writeChunk(const char* type, const unsigned char* data, size_t size) {
+    unsigned char header[8];
+    storeBigEndian(header, static_cast<uint32_t>(size));
+    std::memcpy(header + 4, type, 4);
+    writeBytes(header, sizeof(header));
+    if (size > 0) writeBytes(data, size);
+
+    uint32_t crc = updateCrc(0xFFFFFFFFu, header + 4, 4);
+    crc = updateCrc(crc, data, size) ^ 0xFFFFFFFFu;
+    unsigned char trailer[4];
+    storeBigEndian(trailer, crc);
+    writeBytes(trailer, sizeof(trailer));
+}
+
+void PngStreamWriter::writeBytes(const void* data, size_t size) {
+    if (m_ok && std::fwrite(data, 1, size, m_file) != size) m_ok = false;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+// 閫愯#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+// 逐行写出的 PNG 编码器，用于比内存大得多的图片：只保留上一行和 32 KB 的压缩窗口
+// 每行在 None / Sub / Up / Paeth 四种滤波中选绝对值和最小的一种，再用固定哈夫曼编码的 deflate 压缩，
+// 压缩结果攒够 64 KB 就写成一个 IDAT 块
+class PngStreamWriter {
+public:
+    PngStreamWriter() = default;
+    ~PngStreamWriter();
+    PngStreamWriter(const PngStreamWriter&) = delete;
+    PngStreamWriter& operator=(const PngStreamWriter&) = delete;
+
+    // 创建文件并写入文件头，channels 为 3（RGB）或 4（RGBA），每个通道 8 位
+    bool open(const std::string& path, uint32_t width, uint32_t height, int channels);
+    // 按从上到下的顺序写入一行，长度为 width * channels 字节
+    bool writeRow(const unsigned char* row);
+    // 结束压缩流并关闭文件；写入的行数不等于高度或者中途写文件失败时返回 false
+    bool close();
+
+    bool isOpen() const { return m_file != nullptr; }
+
+private:
+    std::FILE* m_file = nullptr;
+    bool m_ok = false;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    int m_channels = 0;
+    size_t m_rowBytes = 0;
+    uint32_t m_rowsWritten = 0;
+
+    // 上一行的原始数据（第一行之前为全 0），以及四种滤波的结果，每个开头一个滤波类型字节
+    std::vector<unsigned char> m_previousRow;
+    std::vector<unsigned char> m_filtered[4];
+
+    // 压缩窗口：m_window[0] 对应未压缩数据流中的位置 m_windowStart，m_encoded 之前的数据已经编码
+    std::vector<unsigned char> m_window;
+    size_t m_windowStart = 0;
+    size_t m_encoded = 0;
+    // 3 字节哈希链，保存的位置加 1，0 表示空
+    std::vector<size_t> m_hashHead;
+    std::vector<size_t> m_hashPrevious;
+
+    // 按 deflate 规定从低位开始拼接的位缓冲
+    uint32_t m_bitBuffer = 0;
+    int m_bitCount = 0;
+    // 等待写成 IDAT 块的压缩数据
+    std::vector<unsigned char> m_pending;
+    uint32_t m_adlerA = 1;
+    uint32_t m_adlerB = 0;
+
+    void appendData(const unsigned char* data, size_t size);
+    // 压缩窗口中的数据；finish 为 false 时保留不足一个最长匹配的尾部，等后面的数据到了再压缩
+    void compress(bool finish);
+    void insertHash(size_t position);
+    void writeBits(uint32_t value, int count);
+    void writeLiteral(int symbol);
+    void writeMatch(size_t length, size_t distance);
+    void flushPending(bool force);
+    void writeChunk(const char* type, const unsigned char* data, size_t size);
+    void writeBytes(const void* data, size_t size);
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <glad/glad.h>
+#include "TopologyGraph.h"
+
+// GPU 绋嬪簭鍖栨ā寮忕殑椤剁偣鐫€鑹插櫒锛氫笉璇诲彇浠讳綍椤剁偣灞炴€э紝鐩存帴鐢#pragma once
+#include <glad/glad.h>
+#include "TopologyGraph.h"
+
+// GPU 程序化模式的顶点着色器：不读取任何顶点属性，直接由 gl_VertexID 算出顶点坐标
+// 绘制点时 gl_VertexID 就是顶点序号；绘制边时每两个顶点构成一条边，先按和 CPU 生成器相同的顺序算出端点序号
+// 顶点和边的编号规则与 TopologyGraph 中不美化时的球体和圆环完全一致；Application 和 OffscreenRenderer 共用这一份源码
+inline constexpr const char* kProceduralVertexShader = R"(
+    #version 330 core
+    uniform mat4 mvp;
+    uniform int shapeType;      // 0: 圆环，1: 球体
+    uniform ivec2 segments;     // 圆环：主环段数、管道段数；球体：扇区数、半球层数
+    uniform vec2 radii;         // 圆环：主环半径、管道半径
+    uniform bool drawLines;
+
+    const float TWO_PI = 6.28318530718;
+
+    vec3 torusVertex(int index) {
+        int i = index / segments.y;
+        int j = index - i * segments.y;
+        float u = float(i) / float(segments.x) * TWO_PI;
+        float v = float(j) / float(segments.y) * TWO_PI;
+        float ring_r = radii.x + radii.y * cos(v);
+        return vec3(ring_r * cos(u), ring_r * sin(u), radii.y * sin(v));
+    }
+
+    // 每个格点两条边：偶数边沿管道方向，奇数边沿主环方向
+    int torusEndpoint(int edge, int endpoint) {
+        int current = edge / 2;
+        if (endpoint == 0) return current;
+        int i = current / segments.y;
+        int j = current - i * segments.y;
+        if ((edge & 1) == 0) return i * segments.y + (j + 1) % segments.y;
+        return ((i + 1) % segments.x) * segments.y + j;
+    }
+
+    // 0 号顶点是球心，之后每个扇区一条 2 * 层数 + 1 个点的经线
+    vec3 sphereVertex(int index) {
+        if (index == 0) return vec3(0.0);
+        int meridian = 2 * segments.y + 1;
+        int sector = (index - 1) / meridian;
+        int k = index - 1 - sector * meridian;
+        float angle = float(sector) / float(segments.x) * TWO_PI;
+        float z = float(k - segments.y) / float(segments.y);
+        float r = sqrt(max(0.0, 1.0 - z * z));
+        return vec3(r * cos(angle), r * sin(angle), z);
+    }
+
+    int sphereEndpoint(int edge, int endpoint) {
+        int sector = edge / (2 * segments.y);
+        int k = edge - sector * 2 * segments.y;
+        return 1 + sector * (2 * segments.y + 1) + k + endpoint;
+    }
+
+    void main() {
+        int index = gl_VertexID;
+        if (drawLines) {
+            int edge = gl_VertexID / 2;
+            int endpoint = gl_VertexID & 1;
+            index = shapeType == 0 ? torusEndpoint(edge, endpoint) : sphereEndpoint(edge, endpoint);
+        }
+        vec3 pos = shapeType == 0 ? torusVertex(index) : sphereVertex(index);
+        gl_Position = mvp * vec4(pos, 1.0);
+    }
+)";
+
+// 着色器只实现了不美化、不焊接的圆环和球体，其他参数仍然走 CPU 生成
+inline bool supportsProceduralShape(const Parameters& params) {
+    return !params.beautify && !params.weld_vertices &&
+        (params.shape == ShapeType::TORUS || params.shape == ShapeType::SPHERE);
+}
+
+// 设置形状相关的 uniform（shapeType、segments、radii），调用前需要先 glUseProgram(program)
+inline void setProceduralShapeUniforms(GLuint program, const Parameters& params) {
+    if (params.shape == ShapeType::TORUS) {
+        glUniform1i(glGetUniformLocation(program, "shapeType"), 0);
+        glUniform2i(glGetUniformLocation(program, "segments"), params.torus_main_segments, params.torus_tube_segments);
+        glUniform2f(glGetUniformLocation(program, "radii"), params.torus_main_radius, params.torus_tube_radius);
+    }
+    else {
+        glUniform1i(glGetUniformLocation(program, "shapeType"), 1);
+        glUniform2i(glGetUniformLocation(program, "segments"), params.sphere_sectors, params.sphere_layers);
+    }
+}
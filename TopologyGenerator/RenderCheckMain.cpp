@@ -0,0 +1,103 @@
+// GPU 绋嬪簭鍖栨ā寮忕殑妫€鏌ワ細鍚屼竴缁勫弬鏁板垎鍒// GPU 程序化模式的检查：同一组参数分别用 CPU 缓冲区和 gl_VertexID 程序化着色器离屏渲染，逐像素比较两张图
+// 两条路径的顶点编号和坐标公式相同，只允许三角函数精度带来的少量边缘像素差异；没有可用的 EGL 时返回 77（ctest 记为跳过）
+#include "TopologyGraph.h"
+#include "OffscreenRenderer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+const int kImageSize = 256;
+// 通道差超过它的像素算作不同；不同的像素不能超过总数的这个比例
+const int kChannelTolerance = 8;
+const double kMaxDifferentFraction = 0.001;
+
+std::vector<unsigned char> renderImage(OffscreenRenderer& renderer, const glm::mat4& model) {
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 4.0f), glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    renderer.render(view, proj, model);
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(kImageSize) * kImageSize * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, kImageSize, kImageSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+bool compareCase(OffscreenRenderer& renderer, const char* name, const Parameters& params, float degrees) {
+    glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(degrees), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    TopologyGraph graph;
+    graph.generate(params);
+    renderer.upload(graph);
+    std::vector<unsigned char> buffers = renderImage(renderer, model);
+
+    bool supported = renderer.setProcedural(params);
+    std::vector<unsigned char> procedural = renderImage(renderer, model);
+
+    // 背景色之外的像素数，防止两张都是空图时误判为通过
+    size_t drawn = 0;
+    size_t different = 0;
+    int max_difference = 0;
+    size_t pixel_count = static_cast<size_t>(kImageSize) * kImageSize;
+    for (size_t i = 0; i < pixel_count; ++i) {
+        int difference = 0;
+        for (int c = 0; c < 3; ++c) {
+            difference = std::max(difference, std::abs(buffers[i * 4 + c] - procedural[i * 4 + c]));
+        }
+        max_difference = std::max(max_difference, difference);
+        if (difference > kChannelTolerance) ++different;
+        if (buffers[i * 4] != buffers[0] || buffers[i * 4 + 1] != buffers[1] || buffers[i * 4 + 2] != buffers[2]) ++drawn;
+    }
+
+    double fraction = static_cast<double>(different) / pixel_count;
+    bool ok = supported && drawn > pixel_count / 100 && fraction <= kMaxDifferentFraction;
+    std::cout << (ok ? "PASS " : "FAIL ") << name << " (" << drawn << " drawn pixels, " << different
+        << " differ, max channel difference " << max_difference << ")";
+    if (!supported) std::cout << ": parameters not supported by the procedural shader";
+    else if (drawn <= pixel_count / 100) std::cout << ": image is empty";
+    std::cout << "\n";
+    return ok;
+}
+
+}
+
+int main() {
+    OffscreenRenderer renderer;
+    try {
+        renderer.init(kImageSize, kImageSize, 4);
+    }
+    catch (const std::exception& e) {
+        std::cout << "SKIP no offscreen OpenGL context: " << e.what() << "\n";
+        return 77;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
+
+    Parameters torus;
+    torus.shape = ShapeType::TORUS;
+    torus.torus_main_segments = 24;
+    torus.torus_tube_segments = 12;
+    Parameters thick_torus = torus;
+    thick_torus.torus_main_segments = 37;
+    thick_torus.torus_tube_segments = 7;
+    thick_torus.torus_main_radius = 0.8f;
+    thick_torus.torus_tube_radius = 0.45f;
+    Parameters sphere;
+    sphere.shape = ShapeType::SPHERE;
+    sphere.sphere_sectors = 16;
+    sphere.sphere_layers = 6;
+
+    int failures = 0;
+    if (!compareCase(renderer, "torus 24x12", torus, 0.0f)) ++failures;
+    if (!compareCase(renderer, "torus 37x7 rotated", thick_torus, 50.0f)) ++failures;
+    if (!compareCase(renderer, "sphere 16x6 rotated", sphere, 30.0f)) ++failures;
+    renderer.destroy();
+
+    if (failures > 0) std::cout << failures << " check(s) failed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// 鏃犵獥鍙ｇ殑鎵归噺鍑哄浘宸ュ叿锛氬// 无窗口的批量出图工具：对 Parameters 做参数扫描，用 EGL 离屏渲染每个组合，可选绕 y 轴旋转一周输出转台序列
+// 读回第 N+1 帧的同时，线程池中的多个线程在编码第 N 帧及之前的帧；只在 Linux 上构建
+#include "TopologyGraph.h"
+#include "ThreadPool.h"
+#include "OffscreenRenderer.h"
+#include "ScreenCapture.h"
+#include "CommandLine.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// 出图配置
+struct RenderOptions {
+    ParameterSweep sweep;
+    int width = 1024;
+    int height = 1024;
+    int samples = 4;
+    // 每个组合的转台帧数，1 表示只输出一张静止图片
+    int frames = 1;
+    // 转台一共旋转的角度
+    float degrees = 360.0f;
+    std::string outputDir = "render_output";
+    unsigned int threads = 0;
+    // 同时在读回和编码中的帧数上限，0 表示线程数的两倍
+    int inFlight = 0;
+    bool weld = false;
+    // 所有图片按 frame_00000.png 连续编号，便于直接合成视频
+    bool sequence = false;
+    // 圆环和球体用 GPU 程序化模式绘制，不生成也不上传数据
+    bool procedural = false;
+};
+
+void printUsage() {
+    std::cout <<
+        "Usage: TopologyRender [options]\n"
+        "Renders every combination of the given parameter lists to PNG without a window (EGL, no display needed).\n"
+        << kSweepUsage <<
+        "  --width N             image width (default: 1024)\n"
+        "  --height N            image height (default: 1024)\n"
+        "  --samples N           multisample count (default: 4)\n"
+        "  --frames N            turntable frames per mesh, rotating about the y axis like autoRotate (default: 1)\n"
+        "  --degrees X           total turntable rotation (default: 360)\n"
+        "  --out DIR             output directory (default: render_output)\n"
+        "  --threads N           encoder / generator threads (default: all cores)\n"
+        "  --in-flight N         frames being read back or encoded at once (default: 2 x threads)\n"
+        "  --weld                merge coincident points and drop duplicate / degenerate edges\n"
+        "  --sequence            name images frame_00000.png, frame_00001.png, ... across the whole sweep\n"
+        "  --procedural          draw torus / sphere from gl_VertexID like the viewer's GPU procedural mode\n"
+        "                        (other shapes, beautify and --weld fall back to CPU buffers)\n"
+        "  --help                show this message\n";
+}
+
+RenderOptions parseOptions(int argc, char** argv) {
+    RenderOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (arg == "--weld") {
+            options.weld = true;
+            continue;
+        }
+        if (arg == "--sequence") {
+            options.sequence = true;
+            continue;
+        }
+        if (arg == "--procedural") {
+            options.procedural = true;
+            continue;
+        }
+        if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+        std::string value = argv[++i];
+
+        if (parseSweepOption(arg, value, options.sweep)) continue;
+
+        if (arg == "--width") options.width = parseList<int>(arg, value).front();
+        else if (arg == "--height") options.height = parseList<int>(arg, value).front();
+        else if (arg == "--samples") options.samples = parseList<int>(arg, value).front();
+        else if (arg == "--frames") options.frames = parseList<int>(arg, value).front();
+        else if (arg == "--degrees") options.degrees = parseList<float>(arg, value).front();
+        else if (arg == "--out") options.outputDir = value;
+        else if (arg == "--threads") options.threads = static_cast<unsigned int>(parseList<int>(arg, value).front());
+        else if (arg == "--in-flight") options.inFlight = parseList<int>(arg, value).front();
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+    if (options.width <= 0 || options.height <= 0) throw std::invalid_argument("image size must be positive");
+    if (options.frames <= 0) throw std::invalid_argument("--frames must be positive");
+    return options;
+}
+
+}
+
+int main(int argc, char** argv) {
+    RenderOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Parameters> jobs = expandSweep(options.sweep, options.weld);
+    std::cout << "Combinations: " << jobs.size() << ", frames per mesh: " << options.frames << std::endl;
+    if (jobs.empty()) return 0;
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    if (ec) {
+        std::cerr << "Error: cannot create output directory " << options.outputDir << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    OffscreenRenderer renderer;
+    try {
+        renderer.init(options.width, options.height, options.samples);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+    ThreadPool pool(options.threads);
+    int in_flight = options.inFlight > 0 ? options.inFlight : 2 * static_cast<int>(pool.getThreadCount());
+    std::cout << "Worker threads: " << pool.getThreadCount() << ", frames in flight: " << in_flight << std::endl;
+
+    ScreenCapture capture;
+    capture.init(&pool);
+    capture.setVerbose(false);
+
+    // 和 Application 的默认视角相同
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 4.0f), glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), (float)options.width / options.height, 0.1f, 100.0f);
+
+    TopologyGraph graph;
+    graph.setThreadPool(&pool);
+    size_t frame_number = 0;
+    size_t buffer_fallbacks = 0;
+    size_t total_frames = jobs.size() * options.frames;
+    auto startTime = std::chrono::steady_clock::now();
+
+    // 生成和渲染在当前线程依次进行，编码在线程池中和它们重叠
+    for (const Parameters& params : jobs) {
+        // 着色器没有实现的组合仍然在 CPU 上生成后上传
+        if (!options.procedural || !renderer.setProcedural(params)) {
+            graph.generate(params);
+            renderer.upload(graph);
+            if (options.procedural) ++buffer_fallbacks;
+        }
+
+        std::string name = makeFileName(params);
+        for (int frame = 0; frame < options.frames; ++frame) {
+            char file_name[200];
+            if (options.sequence) std::snprintf(file_name, sizeof(file_name), "frame_%05zu.png", frame_number);
+            else if (options.frames == 1) std::snprintf(file_name, sizeof(file_name), "%s.png", name.c_str());
+            else std::snprintf(file_name, sizeof(file_name), "%s_%04d.png", name.c_str(), frame);
+
+            float angle = options.degrees * frame / options.frames;
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+            renderer.render(view, proj, model);
+            capture.requestScreenshot((std::filesystem::path(options.outputDir) / file_name).string(),
+                options.width, options.height);
+            // 把已经读回的帧交给编码线程，积压太多时等待
+            capture.update(options.width, options.height);
+            capture.waitForScreenshots(in_flight);
+
+            ++frame_number;
+            if (frame_number % 100 == 0 || frame_number == total_frames) {
+                std::cout << "[" << frame_number << "/" << total_frames << "]" << std::endl;
+            }
+        }
+    }
+    capture.waitForScreenshots(0);
+    int failed = capture.getFailedScreenshots();
+    capture.destroy();
+    renderer.destroy();
+
+    if (buffer_fallbacks > 0) {
+        std::cout << buffer_fallbacks << " combinations are not supported by --procedural and were drawn from CPU buffers" << std::endl;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Wrote " << (total_frames - failed) << " images to " << options.outputDir << " in " << seconds
+        << " s (" << total_frames / seconds << " frames/s)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
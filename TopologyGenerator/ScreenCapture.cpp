@@ -0,0 +1,283 @@
+#include "ScreenCapture.h"
+#include "ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+void ScreenCapture::init(ThreadPool* pool) {
+    m_pool = pool;
+}
+
+void ScreenCapture::destroy() {
+    // 杩樺湪绛夊緟 GPU 鐨勬埅鍥剧洿鎺ョ瓑瀹冨畬鎴愶紝閬垮厤涓㈠け
+    for (Readback& readback : m_readbacks) {
+        glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000000));
+        finishReadback(readback);
+    }
+    m_readbacks.clear();
+
+    // 杩涜#include "ScreenCapture.h"
+#include "ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+void ScreenCapture::init(ThreadPool* pool) {
+    m_pool = pool;
+}
+
+void ScreenCapture::destroy() {
+    // 还在等待 GPU 的截图直接等它完成，避免丢失
+    for (Readback& readback : m_readbacks) {
+        glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000000));
+        finishReadback(readback);
+    }
+    m_readbacks.clear();
+
+    // 进行中的分块截图只能放弃，已经写出的部分不是完整的 PNG
+    if (m_tiled.active) m_tiled.failed = true;
+    if (m_pool) m_pool->wait();
+    if (m_tiled.active) finishTiledCapture();
+}
+
+void ScreenCapture::requestScreenshot(const std::string& path, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+
+    Readback readback;
+    readback.width = width;
+    readback.height = height;
+    readback.path = path;
+
+    // 读到 PBO 时 glReadPixels 立即返回，GPU 在后面的某个时刻完成复制
+    glGenBuffers(1, &readback.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 3, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_readbacks.push_back(readback);
+}
+
+void ScreenCapture::finishReadback(Readback& readback) {
+    size_t row_bytes = static_cast<size_t>(readback.width) * 3;
+    std::vector<unsigned char> pixels(row_bytes * readback.height);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    const unsigned char* mapped = static_cast<const unsigned char*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixels.size()), GL_MAP_READ_BIT));
+    if (mapped) {
+        // GL 的第一行在底部，复制时顺便上下翻转
+        for (int y = 0; y < readback.height; ++y) {
+            std::memcpy(&pixels[y * row_bytes], mapped + (readback.height - 1 - y) * row_bytes, row_bytes);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteBuffers(1, &readback.pbo);
+    glDeleteSync(readback.fence);
+    if (!mapped) {
+        std::cerr << "错误: 无法读取截图数据 " << readback.path << std::endl;
+        ++m_failed;
+        return;
+    }
+
+    ++m_encoding;
+    int width = readback.width;
+    int height = readback.height;
+    std::string path = readback.path;
+    bool verbose = m_verbose;
+    m_pool->submit([this, pixels = std::move(pixels), width, height, path, verbose]() {
+        if (stbi_write_png(path.c_str(), width, height, 3, pixels.data(), width * 3)) {
+            if (verbose) std::cout << "截图已保存到: " << path << std::endl;
+        }
+        else {
+            std::cerr << "错误: 无法保存截图到 " << path << std::endl;
+            ++m_failed;
+        }
+        --m_encoding;
+    });
+}
+
+bool ScreenCapture::startTiledCapture(const std::string& path, int width, int height, TileRenderer renderer) {
+    if (m_tiled.active || width <= 0 || height <= 0) return false;
+
+    GLint max_renderbuffer = 0, max_samples = 0;
+    GLint max_viewport[2] = { 0, 0 };
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_renderbuffer);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, max_viewport);
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    int tile_size = std::min({ kMaxTileSize, static_cast<int>(max_renderbuffer), static_cast<int>(max_viewport[0]), static_cast<int>(max_viewport[1]) });
+    // 和窗口一样使用 4 倍多重采样
+    int samples = std::min(4, static_cast<int>(max_samples));
+
+    TiledCapture& tiled = m_tiled;
+    glGenFramebuffers(1, &tiled.fbo);
+    glGenRenderbuffers(1, &tiled.colorBuffer);
+    glGenRenderbuffers(1, &tiled.depthBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, tiled.fbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, tiled.colorBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, tile_size, tile_size);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, tiled.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, tiled.depthBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, tile_size, tile_size);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, tiled.depthBuffer);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glGenFramebuffers(1, &tiled.resolveFbo);
+    glGenRenderbuffers(1, &tiled.resolveBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, tiled.resolveFbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, tiled.resolveBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, tile_size, tile_size);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, tiled.resolveBuffer);
+    complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    tiled.writer = std::make_unique<PngStreamWriter>();
+    if (!complete || !tiled.writer->open(path, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 3)) {
+        std::cerr << "错误: 无法开始分块截图 " << path << std::endl;
+        tiled.writer.reset();
+        releaseTiledTargets();
+        return false;
+    }
+
+    tiled.active = true;
+    tiled.path = path;
+    tiled.width = width;
+    tiled.height = height;
+    tiled.tileSize = tile_size;
+    tiled.nextBand = 0;
+    tiled.bandCount = (height + tile_size - 1) / tile_size;
+    tiled.renderer = std::move(renderer);
+    tiled.band.resize(static_cast<size_t>(width) * std::min(tile_size, height) * 3);
+    tiled.rowsEncoded = 0;
+    tiled.failed = false;
+    return true;
+}
+
+void ScreenCapture::update(int windowWidth, int windowHeight) {
+    for (size_t i = 0; i < m_readbacks.size();) {
+        GLenum status = glClientWaitSync(m_readbacks[i].fence, 0, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            finishReadback(m_readbacks[i]);
+            m_readbacks.erase(m_readbacks.begin() + i);
+        }
+        else {
+            ++i;
+        }
+    }
+
+    // 编码线程还在处理上一行块时这一帧不渲染
+    if (!m_tiled.active || m_tiled.encoding.load(std::memory_order_acquire)) return;
+    if (m_tiled.failed || m_tiled.nextBand == m_tiled.bandCount) {
+        finishTiledCapture();
+        return;
+    }
+    renderBand();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowWidth, windowHeight);
+}
+
+void ScreenCapture::waitForScreenshots(int maxPending) {
+    // 先按请求顺序取回最早的读回，取回后交给线程池编码
+    while (getPendingScreenshots() > maxPending && !m_readbacks.empty()) {
+        glClientWaitSync(m_readbacks.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000000));
+        finishReadback(m_readbacks.front());
+        m_readbacks.erase(m_readbacks.begin());
+    }
+    // 剩下的都在编码，编码线程结束时只减少计数，这里轮询等待
+    while (getPendingScreenshots() > maxPending) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void ScreenCapture::renderBand() {
+    TiledCapture& tiled = m_tiled;
+    int width = tiled.width;
+    int height = tiled.height;
+    // 行块从图片顶部往下排，换算成 GL 从底部算起的坐标
+    int band_top = tiled.nextBand * tiled.tileSize;
+    int band_height = std::min(tiled.tileSize, height - band_top);
+    int band_bottom = height - band_top - band_height;
+
+    for (int x = 0; x < width; x += tiled.tileSize) {
+        int tile_width = std::min(tiled.tileSize, width - x);
+
+        // 把整张图裁剪空间中这一块的范围缩放平移到 [-1, 1]
+        float center_x = (2.0f * x + tile_width) / width - 1.0f;
+        float center_y = (2.0f * band_bottom + band_height) / height - 1.0f;
+        glm::mat4 tile_transform = glm::scale(glm::mat4(1.0f), glm::vec3(float(width) / tile_width, float(height) / band_height, 1.0f));
+        tile_transform = glm::translate(tile_transform, glm::vec3(-center_x, -center_y, 0.0f));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, tiled.fbo);
+        glViewport(0, 0, tile_width, band_height);
+        tiled.renderer(tile_transform);
+
+        // 解析多重采样后直接读到行块中对应的列，读取会等待这一块渲染完成
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, tiled.fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, tiled.resolveFbo);
+        glBlitFramebuffer(0, 0, tile_width, band_height, 0, 0, tile_width, band_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, tiled.resolveFbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_PACK_ROW_LENGTH, width);
+        glReadPixels(0, 0, tile_width, band_height, GL_RGB, GL_UNSIGNED_BYTE, &tiled.band[static_cast<size_t>(x) * 3]);
+    }
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    ++tiled.nextBand;
+
+    // 行块按从下往上存放，编码时倒序写出
+    tiled.encoding.store(true, std::memory_order_relaxed);
+    m_pool->submit([this, band_height]() {
+        TiledCapture& tiled = m_tiled;
+        size_t row_bytes = static_cast<size_t>(tiled.width) * 3;
+        for (int row = band_height - 1; row >= 0 && !tiled.failed; --row) {
+            if (!tiled.writer->writeRow(&tiled.band[row * row_bytes])) tiled.failed = true;
+        }
+        tiled.rowsEncoded += band_height;
+        tiled.encoding.store(false, std::memory_order_release);
+    });
+}
+
+void ScreenCapture::finishTiledCapture() {
+    TiledCapture& tiled = m_tiled;
+    bool ok = tiled.writer->close() && !tiled.failed;
+    if (ok) std::cout << "分块截图已保存到: " << tiled.path << " (" << tiled.width << "x" << tiled.height << ")" << std::endl;
+    else std::cerr << "错误: 无法保存分块截图到 " << tiled.path << std::endl;
+
+    tiled.writer.reset();
+    tiled.renderer = nullptr;
+    std::vector<unsigned char>().swap(tiled.band);
+    releaseTiledTargets();
+    tiled.active = false;
+}
+
+void ScreenCapture::releaseTiledTargets() {
+    TiledCapture& tiled = m_tiled;
+    glDeleteFramebuffers(1, &tiled.fbo);
+    glDeleteRenderbuffers(1, &tiled.colorBuffer);
+    glDeleteRenderbuffers(1, &tiled.depthBuffer);
+    glDeleteFramebuffers(1, &tiled.resolveFbo);
+    glDeleteRenderbuffers(1, &tiled.resolveBuffer);
+    tiled.fbo = tiled.colorBuffer = tiled.depthBuffer = 0;
+    tiled.resolveFbo = tiled.resolveBuffer = 0;
+}
+
+float ScreenCapture::getTiledProgress() const {
+    if (!m_tiled.active || m_tiled.height == 0) return 0.0f;
+    return static_cast<float>(m_tiled.rowsEncoded.load()) / m_tiled.height;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "PngStreamWriter.h"
+
+class ThreadPool;
+
+// 鎴#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "PngStreamWriter.h"
+
+class ThreadPool;
+
+// 截图：glReadPixels 先读到像素缓冲区对象（PBO）里，GPU 写完（栅栏到达）之后再映射取回，PNG 编码和写文件交给线程池，渲染线程不等待
+// 分块截图：把比窗口大的图片切成若干块渲染到帧缓冲区对象，每帧渲染一行块交给流式 PNG 编码器，内存中最多只有一行块的像素
+class ScreenCapture {
+public:
+    // 渲染一块时调用；tileTransform 把整张图的裁剪空间映射到这一块，应左乘到投影矩阵上
+    // 调用前已经绑定好这一块的帧缓冲区和视口，回调负责清屏和绘制
+    using TileRenderer = std::function<void(const glm::mat4& tileTransform)>;
+
+    // 分块的最大边长，实际还受 GL_MAX_RENDERBUFFER_SIZE 和 GL_MAX_VIEWPORT_DIMS 限制
+    static const int kMaxTileSize = 2048;
+
+    ScreenCapture() = default;
+    ScreenCapture(const ScreenCapture&) = delete;
+    ScreenCapture& operator=(const ScreenCapture&) = delete;
+
+    void init(ThreadPool* pool);
+    // 取回还没读回的截图，等待所有编码结束，释放 GL 资源；必须在 GL 上下文销毁之前调用
+    void destroy();
+
+    // 异步保存当前读帧缓冲区（窗口）左下角 width x height 的内容
+    void requestScreenshot(const std::string& path, int width, int height);
+    // 开始分块截图，之后每次 update 渲染一行块；正在进行分块截图或者无法创建帧缓冲区时返回 false
+    bool startTiledCapture(const std::string& path, int width, int height, TileRenderer renderer);
+    // 每帧调用一次：把已经读回的截图交给线程池编码，推进分块截图
+    // 分块截图会改变帧缓冲区和视口，结束时恢复为窗口的帧缓冲区和 windowWidth x windowHeight 的视口
+    void update(int windowWidth, int windowHeight);
+    // 阻塞到还没写完的普通截图不超过 maxPending 张，用于没有窗口、连续渲染大量图片时限制占用的内存
+    void waitForScreenshots(int maxPending);
+    // 关闭后保存成功时不再逐张输出文件名，错误仍然输出
+    void setVerbose(bool verbose) { m_verbose = verbose; }
+
+    bool isTiledCaptureActive() const { return m_tiled.active; }
+    // 分块截图已编码的行数占总行数的比例
+    float getTiledProgress() const;
+    // 还没写完的普通截图数量（包括等待读回和正在编码的）
+    int getPendingScreenshots() const { return static_cast<int>(m_readbacks.size()) + m_encoding.load(); }
+    // 读取或保存失败的普通截图数量
+    int getFailedScreenshots() const { return m_failed.load(); }
+
+private:
+    // 等待 GPU 写完的读回
+    struct Readback {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        std::string path;
+    };
+
+    struct TiledCapture {
+        bool active = false;
+        std::string path;
+        int width = 0;
+        int height = 0;
+        int tileSize = 0;
+        int nextBand = 0;
+        int bandCount = 0;
+        TileRenderer renderer;
+        // 一行块的像素，按 GL 的习惯从下往上存放
+        std::vector<unsigned char> band;
+        std::unique_ptr<PngStreamWriter> writer;
+        // 多重采样的渲染目标，以及解析多重采样后用来读取像素的目标
+        GLuint fbo = 0, colorBuffer = 0, depthBuffer = 0;
+        GLuint resolveFbo = 0, resolveBuffer = 0;
+        // 编码线程正在处理 band 时为 true，处理完之前渲染线程不会写 band
+        std::atomic<bool> encoding{ false };
+        std::atomic<int> rowsEncoded{ 0 };
+        std::atomic<bool> failed{ false };
+    };
+
+    ThreadPool* m_pool = nullptr;
+    std::vector<Readback> m_readbacks;
+    std::atomic<int> m_encoding{ 0 };
+    std::atomic<int> m_failed{ 0 };
+    bool m_verbose = true;
+    TiledCapture m_tiled;
+
+    // 映射 PBO 取出像素，交给线程池编码
+    void finishReadback(Readback& readback);
+    void renderBand();
+    void finishTiledCapture();
+    void releaseTiledTargets();
+};
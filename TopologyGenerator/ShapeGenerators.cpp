@@ -0,0 +1,745 @@
+#include "ShapeGenerators.h"
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+
+using ShapeGenerators::kMinParallelVertices;
+
+// 鍦嗙幆缇庡寲缁撴瀯鐨勫垎鍧楁暟閲忓拰鍚勯儴鍒嗗湪鏁扮粍涓#include "ShapeGenerators.h"
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+
+using ShapeGenerators::kMinParallelVertices;
+
+// 圆环美化结构的分块数量和各部分在数组中的起始位置，size 和 fill 共用
+struct TorusBeautifyLayout {
+    // 内部螺旋线所在的主段数（每隔一个主段）
+    size_t spiralSegments;
+    // 径向线所在的主段数（每隔三个主段）
+    size_t radialSegments;
+    // 每个主段上径向线所在的管段数（每隔一个管段）
+    size_t radialTubeSegments;
+
+    // 每个主段上内部螺旋线、径向线占用的顶点数和索引数，以及每条装饰螺旋线占用的数量
+    size_t spiralBlockVertices, spiralBlockIndices;
+    size_t radialBlockVertices, radialBlockIndices;
+    size_t decorativeVertices, decorativeIndices;
+
+    // 各部分的起始位置，依次排在基础圆环管之后
+    size_t spiralVertexOffset, spiralIndexOffset;
+    size_t radialVertexOffset, radialIndexOffset;
+    size_t decorativeVertexOffset, decorativeIndexOffset;
+    size_t vertexCount, indexCount;
+
+    TorusBeautifyLayout(int main_segments, int tube_segments) {
+        size_t m = main_segments;
+        size_t t = tube_segments;
+        spiralSegments = (m + 1) / 2;
+        radialSegments = (m + 2) / 3;
+        radialTubeSegments = (t + 1) / 2;
+
+        // 内部螺旋线：每段 3 条，每条 t+1 个点，t 条螺旋边 + t 条连管壁的边
+        spiralBlockVertices = 3 * (t + 1);
+        spiralBlockIndices = 3 * 4 * t;
+        // 径向线：每处 3 个点，3 条连管壁的边 + 2 条层间边
+        radialBlockVertices = radialTubeSegments * 3;
+        radialBlockIndices = radialTubeSegments * 10;
+        // 装饰螺旋线：每条 2m+1 个点
+        decorativeVertices = 2 * m + 1;
+        decorativeIndices = 4 * m;
+
+        // 基础圆环管：每个格点两条边，沿管方向和沿主环方向
+        spiralVertexOffset = m * t;
+        spiralIndexOffset = 4 * m * t;
+        radialVertexOffset = spiralVertexOffset + spiralSegments * spiralBlockVertices;
+        radialIndexOffset = spiralIndexOffset + spiralSegments * spiralBlockIndices;
+        decorativeVertexOffset = radialVertexOffset + radialSegments * radialBlockVertices;
+        decorativeIndexOffset = radialIndexOffset + radialSegments * radialBlockIndices;
+        // 共 4 条装饰螺旋线
+        vertexCount = decorativeVertexOffset + 4 * decorativeVertices;
+        indexCount = decorativeIndexOffset + 4 * decorativeIndices;
+    }
+};
+
+// 常用段数（各形状的默认值和滑动条的常见取值）的角度表在编译期算好
+template <int Count>
+bool copyRingPreset(int count, AngleTable& table) {
+    static constexpr RingTable<Count> kTable;
+    if (count != Count) return false;
+    table.sines.assign(kTable.sines, kTable.sines + Count);
+    table.cosines.assign(kTable.cosines, kTable.cosines + Count);
+    return true;
+}
+
+template <int... Counts>
+bool copyRingPresets(int count, AngleTable& table) {
+    return (copyRingPreset<Counts>(count, table) || ...);
+}
+
+// 每种形状一个类型，提供两个静态函数模板：
+//   size<Beautify>(params)                   顶点数和索引数，参数无效时为 0
+//   fill<Beautify, UpdateIndices>(params, out)  按 size 的数量和顺序写入，UpdateIndices 为 false 时只写顶点坐标
+// fill 只在 size 不为 0 时调用，不用再检查参数
+
+struct Topology2DShape {
+    template <bool Beautify>
+    static MeshSize size(const Parameters& params) {
+        MeshSize size;
+        int num_sides = params.topology_sides;
+        int points_per_sector = params.topology_points_per_sector;
+        if (num_sides < 3 || points_per_sector < 1) return size;
+        size_t n = num_sides;
+        size_t p = points_per_sector;
+        // 中心点 + 外圈点；中心到外圈的边 + 外圈多边形的边
+        size.vertexCount = 1 + n;
+        size.indexCount = 4 * n;
+        if (Beautify) {
+            // 每个扇区 p 个子结构点；子结构内部 p-1 条边 + 连外圈 1 条 + 连中心 1 条
+            size.vertexCount += n * p;
+            size.indexCount += n * (2 * p + 2);
+        }
+        return size;
+    }
+
+    template <bool Beautify, bool UpdateIndices>
+    static void fill(const Parameters& params, const ShapeOutput& out) {
+        int num_sides = params.topology_sides;
+        int points_per_sector = params.topology_points_per_sector;
+        glm::vec3* vertices = out.vertices;
+        unsigned int* indices = out.indices;
+
+        // 圆环半径（正多边形的点都在这个圆环上）
+        float outer_radius = 1.0f;
+
+        // 添加中心点
+        vertices[0] = glm::vec3(0.0f, 0.0f, 0.0f);
+
+        // 外圈顶点的角度表，同时用于旋转子结构
+        AngleTable ring = ShapeGenerators::makeRingTable(num_sides);
+
+        // 添加 N 边形的 N 个外圈顶点 (顶点 1 到 N)
+        for (int i = 0; i < num_sides; ++i) {
+            float x = outer_radius * ring.cosines[i];
+            float y = outer_radius * ring.sines[i];
+            vertices[1 + i] = glm::vec3(x, y, 0.0f);
+        }
+
+        // 中心点(0) + 外圈点(num_sides) 之后的第一个顶点索引
+        int base_vertex_offset = 1 + num_sides;
+        int vertices_per_sector = points_per_sector;
+
+        if constexpr (UpdateIndices) {
+            // 连接中心点到所有外圈顶点
+            for (int i = 1; i <= num_sides; ++i) {
+                *indices++ = 0; // 中心点
+                *indices++ = i; // 外圈顶点
+            }
+
+            // 连接外圈顶点形成多边形
+            for (int i = 1; i <= num_sides; ++i) {
+                *indices++ = i;
+                int next_vertex_index = (i == num_sides) ? 1 : i + 1;
+                *indices++ = next_vertex_index;
+            }
+        }
+
+        if constexpr (Beautify) {
+            // 定义一个基本单元（子结构），位于圆内部
+            std::vector<glm::vec3> base_unit = ShapeGenerators::makeTopologyUnit(num_sides, points_per_sector, outer_radius);
+
+            // 复制并旋转子结构，放置在每个扇区内，扇区 i 的旋转角和外圈第 i 个点相同
+            glm::vec3* sector_vertices = vertices + base_vertex_offset;
+            for (int i = 0; i < num_sides; ++i) {
+                float c = ring.cosines[i];
+                float s = ring.sines[i];
+                for (const auto& point : base_unit) {
+                    // 旋转点
+                    float x = point.x * c - point.y * s;
+                    float y = point.x * s + point.y * c;
+                    *sector_vertices++ = glm::vec3(x, y, 0.0f);
+                }
+            }
+
+            if constexpr (UpdateIndices) {
+                // 连接每个子结构内部的点
+                for (int i = 0; i < num_sides; ++i) {
+                    int start = base_vertex_offset + i * vertices_per_sector;
+                    for (int j = 0; j < vertices_per_sector - 1; ++j) {
+                        *indices++ = start + j;
+                        *indices++ = start + j + 1;
+                    }
+                    // 连接子结构最后一个点到外圈顶点
+                    *indices++ = start + vertices_per_sector - 1;
+                    *indices++ = 1 + i; // 对应外圈第 i 个点
+                }
+
+                // 连接中心点到子结构的某些点
+                for (int i = 0; i < num_sides; ++i) {
+                    int sector_start_index = base_vertex_offset + i * vertices_per_sector;
+                    // 连接到子结构的第一个点
+                    *indices++ = 0; // 中心点
+                    *indices++ = sector_start_index; // 子结构内部点
+                }
+            }
+        }
+    }
+};
+
+struct SphereShape {
+    template <bool Beautify>
+    static MeshSize size(const Parameters& params) {
+        MeshSize size;
+        int sectors = params.sphere_sectors;
+        int points_per_sector = params.sphere_points_per_sector;
+        int layers = params.sphere_layers;
+        if (sectors < 3 || layers < 1) return size;
+        if (Beautify && points_per_sector < 1) return size;
+        size_t s = sectors;
+        size_t l = layers;
+        size_t p = points_per_sector;
+        // 球心 + 每个扇区一条 2l+1 个点的经线
+        size.vertexCount = 1 + s * (2 * l + 1);
+        size.indexCount = s * 4 * l;
+        if (Beautify) {
+            // 每个扇区两条 p+1 个点的螺旋线
+            size.vertexCount += s * 2 * (p + 1);
+            size.indexCount += s * 4 * p;
+        }
+        return size;
+    }
+
+    template <bool Beautify, bool UpdateIndices>
+    static void fill(const Parameters& params, const ShapeOutput& out) {
+        int sectors = params.sphere_sectors;
+        int points_per_sector = params.sphere_points_per_sector;
+        int layers = params.sphere_layers;
+
+        // 每个扇区占用的顶点数和索引数都相同，扇区 i 的数据从 i * 块大小 处开始
+        int meridian_points = 2 * layers + 1;
+        int spiral_points = points_per_sector + 1;
+        size_t sector_vertex_count = meridian_points + (Beautify ? 2 * spiral_points : 0);
+        size_t sector_index_count = 4 * layers + (Beautify ? 4 * points_per_sector : 0);
+
+        // 添加球心点
+        out.vertices[0] = glm::vec3(0.0f, 0.0f, 0.0f);
+        float radius = 1.0f;
+
+        // 在XOY平面上生成正多边形的顶点作为球面点，扇区角度表
+        AngleTable sector_table = ShapeGenerators::makeRingTable(sectors);
+
+        // 经线上各层的高度和截面半径对所有扇区都相同，只算一次
+        std::vector<float> layer_z;
+        std::vector<float> layer_radius;
+        ShapeGenerators::makeSphereLayers(layers, radius, layer_z, layer_radius);
+
+        // 扇区 0 内的两条螺旋线，其他扇区的螺旋线由它旋转得到
+        std::vector<glm::vec3> spiral_unit;
+        if constexpr (Beautify) spiral_unit = ShapeGenerators::makeSphereSpiralUnit(sectors, points_per_sector, radius);
+
+        // 各扇区写入互不重叠的区间，可以按扇区并行生成
+        size_t min_chunk = std::max<size_t>(1, kMinParallelVertices / sector_vertex_count);
+        out.forEachRange(sectors, min_chunk, [&](size_t sector_begin, size_t sector_end) {
+            for (int i = static_cast<int>(sector_begin); i < static_cast<int>(sector_end); ++i) {
+                float c = sector_table.cosines[i];
+                float s = sector_table.sines[i];
+
+                // 当前扇区第一个点的索引
+                unsigned int idx = static_cast<unsigned int>(1 + i * sector_vertex_count);
+                glm::vec3* vertices = out.vertices + idx;
+                unsigned int* indices = out.indices + i * sector_index_count;
+
+                for (int j = 0; j < meridian_points; ++j) {
+                    float x = layer_radius[j] * c;
+                    float y = layer_radius[j] * s;
+                    *vertices++ = glm::vec3(x, y, layer_z[j]);
+                }
+
+                // 连接相邻的表面点形成球面环
+                if constexpr (UpdateIndices) {
+                    for (int k = 0; k < 2 * layers; ++k) {
+                        *indices++ = idx + k;
+                        *indices++ = idx + k + 1;
+                    }
+                }
+
+                // 美化时添加扇面内的三维螺旋线
+                if constexpr (Beautify) {
+                    // 把扇区 0 的两条螺旋线旋转到当前扇区
+                    for (const auto& point : spiral_unit) {
+                        float x = point.x * c - point.y * s;
+                        float y = point.x * s + point.y * c;
+                        *vertices++ = glm::vec3(x, y, point.z);
+                    }
+
+                    // 连接两条螺旋线上各自的相邻点
+                    if constexpr (UpdateIndices) {
+                        unsigned int spiral1_start = idx + meridian_points;
+                        unsigned int spiral2_start = spiral1_start + spiral_points;
+                        for (int k = 0; k < points_per_sector; ++k) {
+                            *indices++ = spiral1_start + k;
+                            *indices++ = spiral1_start + k + 1;
+                        }
+                        for (int k = 0; k < points_per_sector; ++k) {
+                            *indices++ = spiral2_start + k;
+                            *indices++ = spiral2_start + k + 1;
+                        }
+                    }
+                }
+            }
+        });
+    }
+};
+
+struct TorusShape {
+    template <bool Beautify>
+    static MeshSize size(const Parameters& params) {
+        MeshSize size;
+        int main_segments = params.torus_main_segments;
+        int tube_segments = params.torus_tube_segments;
+        if (main_segments < 1 || tube_segments < 1) return size;
+        if (Beautify) {
+            TorusBeautifyLayout layout(main_segments, tube_segments);
+            size.vertexCount = layout.vertexCount;
+            size.indexCount = layout.indexCount;
+        }
+        else {
+            // 每个格点两条边：沿管方向和沿主环方向
+            size.vertexCount = static_cast<size_t>(main_segments) * tube_segments;
+            size.indexCount = 4 * size.vertexCount;
+        }
+        return size;
+    }
+
+    template <bool Beautify, bool UpdateIndices>
+    static void fill(const Parameters& params, const ShapeOutput& out) {
+        int main_segments = params.torus_main_segments;
+        int tube_segments = params.torus_tube_segments;
+        float main_r = params.torus_main_radius;
+        float tube_r = params.torus_tube_radius;
+
+        // 主环角 u 只和 i 有关，管道角 v 只和 j 有关，先各算一张表，格点上不再调用三角函数
+        AngleTable u_table = ShapeGenerators::makeRingTable(main_segments);
+        AngleTable v_table = ShapeGenerators::makeRingTable(tube_segments);
+
+        // 每个主段的输出位置都能由循环下标直接算出，按主段划分后可以并行写入互不重叠的区间
+        size_t min_chunk = std::max<size_t>(1, kMinParallelVertices / tube_segments);
+
+        // 绘制基础圆环管
+        out.forEachRange(main_segments, min_chunk, [&](size_t segment_begin, size_t segment_end) {
+            for (int i = static_cast<int>(segment_begin); i < static_cast<int>(segment_end); ++i) {
+                glm::vec3* vertices = out.vertices + static_cast<size_t>(i) * tube_segments;
+                unsigned int* indices = out.indices + static_cast<size_t>(i) * tube_segments * 4;
+                float cos_u = u_table.cosines[i];
+                float sin_u = u_table.sines[i];
+                for (int j = 0; j < tube_segments; ++j) {
+                    float ring_r = main_r + tube_r * v_table.cosines[j];
+                    float x = ring_r * cos_u;
+                    float y = ring_r * sin_u;
+                    float z = tube_r * v_table.sines[j];
+                    *vertices++ = glm::vec3(x, y, z);
+                    if constexpr (UpdateIndices) {
+                        unsigned int current = i * tube_segments + j;
+                        unsigned int next_j = i * tube_segments + (j + 1) % tube_segments;
+                        unsigned int next_i = ((i + 1) % main_segments) * tube_segments + j;
+                        *indices++ = current; *indices++ = next_j;
+                        *indices++ = current; *indices++ = next_i;
+                    }
+                }
+            }
+        });
+
+        if constexpr (Beautify) fillBeautify<UpdateIndices>(params, out, u_table, v_table);
+    }
+
+    template <bool UpdateIndices>
+    static void fillBeautify(const Parameters& params, const ShapeOutput& out, const AngleTable& u_table, const AngleTable& v_table) {
+        int main_segments = params.torus_main_segments;
+        int tube_segments = params.torus_tube_segments;
+        float main_r = params.torus_main_radius;
+        float tube_r = params.torus_tube_radius;
+        TorusBeautifyLayout layout(main_segments, tube_segments);
+
+        // 内部螺旋线的管道角只和螺旋线编号 k 以及点的序号有关，3 条螺旋线共用一张表
+        std::vector<float> inner_angles(3 * (tube_segments + 1));
+        for (int k = 0; k < 3; ++k) {
+            float phase_offset = static_cast<float>(k) * 2.0f * glm::pi<float>() / 3.0f;  // 相位偏移
+            for (int spiral = 0; spiral <= tube_segments; ++spiral) {
+                inner_angles[k * (tube_segments + 1) + spiral] = (float)spiral / tube_segments * 2.0f * glm::pi<float>() * 2.0f + phase_offset;  // 螺旋角度
+            }
+        }
+        AngleTable inner_table;
+        inner_table.build(inner_angles);
+
+        // 装饰螺旋线的主环角和管道角
+        std::vector<float> decorative_u(4 * layout.decorativeVertices);
+        std::vector<float> decorative_v(4 * layout.decorativeVertices);
+        for (int spiral_num = 0; spiral_num < 4; ++spiral_num) {
+            float main_spiral_offset = static_cast<float>(spiral_num) * glm::pi<float>() / 2.0f;
+            for (int k = 0; k <= main_segments * 2; ++k) {
+                // 跨越2圈的螺旋
+                float main_progress = static_cast<float>(k) / (main_segments * 2);
+                decorative_u[spiral_num * layout.decorativeVertices + k] = main_progress * 2.0f * glm::pi<float>() * 2.0f + main_spiral_offset;
+                decorative_v[spiral_num * layout.decorativeVertices + k] = main_progress * 2.0f * glm::pi<float>() * 3.0f + main_spiral_offset;
+            }
+        }
+        AngleTable decorative_u_table;
+        decorative_u_table.build(decorative_u);
+        AngleTable decorative_v_table;
+        decorative_v_table.build(decorative_v);
+
+        // 在管道内部添加螺旋线点和边
+        out.forEachRange(layout.spiralSegments, std::max<size_t>(1, kMinParallelVertices / layout.spiralBlockVertices),
+            [&](size_t block_begin, size_t block_end) {
+            for (size_t block = block_begin; block < block_end; ++block) {
+                // 每隔一个主段添加内部结构
+                int i = static_cast<int>(block * 2);
+                size_t vertex_offset = layout.spiralVertexOffset + block * layout.spiralBlockVertices;
+                glm::vec3* vertices = out.vertices + vertex_offset;
+                unsigned int* indices = out.indices + layout.spiralIndexOffset + block * layout.spiralBlockIndices;
+                float cos_u = u_table.cosines[i];
+                float sin_u = u_table.sines[i];
+                float inner_tube_r = tube_r * 0.5f;
+
+                for (int k = 0; k < 3; ++k) {
+                    // 每个主段添加3条内部螺旋线
+                    unsigned int spiral_start = static_cast<unsigned int>(vertex_offset + k * (tube_segments + 1));
+                    const float* cos_v = inner_table.cosines.data() + k * (tube_segments + 1);
+                    const float* sin_v = inner_table.sines.data() + k * (tube_segments + 1);
+
+                    for (int spiral = 0; spiral <= tube_segments; ++spiral) {
+                        float ring_r = main_r + inner_tube_r * cos_v[spiral];
+                        *vertices++ = glm::vec3(ring_r * cos_u, ring_r * sin_u, inner_tube_r * sin_v[spiral]);
+                    }
+
+                    if constexpr (UpdateIndices) {
+                        // 连接内部螺旋线上的相邻点
+                        for (int p = 0; p < tube_segments; ++p) {
+                            *indices++ = spiral_start + p;
+                            *indices++ = spiral_start + p + 1;
+                        }
+
+                        // 连接内部螺旋线到外部管壁
+                        for (int p = 0; p < tube_segments; ++p) {
+                            unsigned int outer_idx = i * tube_segments + p;
+                            *indices++ = spiral_start + p;
+                            *indices++ = outer_idx;
+                        }
+                    }
+                }
+            }
+        });
+
+        // 添加管子截面内的径向线，角度和基础圆环管的格点相同，直接查表
+        out.forEachRange(layout.radialSegments, std::max<size_t>(1, kMinParallelVertices / std::max<size_t>(1, layout.radialBlockVertices)),
+            [&](size_t block_begin, size_t block_end) {
+            for (size_t block = block_begin; block < block_end; ++block) {
+                // 每隔几个主段添加径向结构
+                int i = static_cast<int>(block * 3);
+                size_t vertex_offset = layout.radialVertexOffset + block * layout.radialBlockVertices;
+                glm::vec3* vertices = out.vertices + vertex_offset;
+                unsigned int* indices = out.indices + layout.radialIndexOffset + block * layout.radialBlockIndices;
+                float cos_u = u_table.cosines[i];
+                float sin_u = u_table.sines[i];
+
+                for (int j = 0; j < tube_segments; j += 2) {
+                    // 每隔几个管段添加径向线
+
+                    // 添加管子内部的径向点
+                    for (int radial = 1; radial <= 3; ++radial) {
+                        float radial_ratio = static_cast<float>(radial) / 4.0f;
+                        float inner_tube_r = tube_r * radial_ratio;
+
+                        float ring_r = main_r + inner_tube_r * v_table.cosines[j];
+                        float x = ring_r * cos_u;
+                        float y = ring_r * sin_u;
+                        float z = inner_tube_r * v_table.sines[j];
+
+                        unsigned int inner_radial_idx = static_cast<unsigned int>(vertices - out.vertices);
+                        *vertices++ = glm::vec3(x, y, z);
+
+                        if constexpr (UpdateIndices) {
+                            // 连接到管壁上的对应点
+                            unsigned int outer_idx = i * tube_segments + j;
+                            *indices++ = inner_radial_idx;
+                            *indices++ = outer_idx;
+
+                            // 连接内部径向点之间的层
+                            if (radial > 1) {
+                                *indices++ = inner_radial_idx;
+                                *indices++ = inner_radial_idx - 1;
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        // 添加装饰性螺旋线，4 条螺旋线各自独立
+        out.forEachRange(4, 1, [&](size_t spiral_begin, size_t spiral_end) {
+            for (int spiral_num = static_cast<int>(spiral_begin); spiral_num < static_cast<int>(spiral_end); ++spiral_num) {
+                size_t vertex_offset = layout.decorativeVertexOffset + spiral_num * layout.decorativeVertices;
+                glm::vec3* vertices = out.vertices + vertex_offset;
+                unsigned int* indices = out.indices + layout.decorativeIndexOffset + spiral_num * layout.decorativeIndices;
+                unsigned int spiral_start = static_cast<unsigned int>(vertex_offset);
+                size_t table_offset = spiral_num * layout.decorativeVertices;
+                float inner_tube_r = tube_r * 0.7f;
+
+                for (size_t k = 0; k < layout.decorativeVertices; ++k) {
+                    float ring_r = main_r + inner_tube_r * decorative_v_table.cosines[table_offset + k];
+                    float x = ring_r * decorative_u_table.cosines[table_offset + k];
+                    float y = ring_r * decorative_u_table.sines[table_offset + k];
+                    float z = inner_tube_r * decorative_v_table.sines[table_offset + k];
+                    *vertices++ = glm::vec3(x, y, z);
+                }
+
+                // 连接装饰螺旋线上的相邻点
+                if constexpr (UpdateIndices) {
+                    for (int p = 0; p < main_segments * 2; ++p) {
+                        *indices++ = spiral_start + p;
+                        *indices++ = spiral_start + p + 1;
+                    }
+                }
+            }
+        });
+    }
+};
+
+// 立方体晶格：每条棱分成 n 段，(n+1)^3 个格点沿 x、y、z 三个方向连接相邻格点
+// 美化时在每个小立方体的中心加一个点并连到它的 8 个角，得到体心立方晶格
+// 格点按 z 层、y 行、x 列的顺序存放，每一层的数据块位置都能直接算出，按层并行生成
+struct CubeShape {
+    template <bool Beautify>
+    static MeshSize size(const Parameters& params) {
+        MeshSize size;
+        if (params.cube_segments < 1) return size;
+        size_t n = params.cube_segments;
+        size_t side = n + 1;
+        // 格点；三个方向各 n * (n+1)^2 条边
+        size.vertexCount = side * side * side;
+        size.indexCount = 6 * n * side * side;
+        if (Beautify) {
+            // n^3 个体心点，每个连 8 条边
+            size.vertexCount += n * n * n;
+            size.indexCount += 16 * n * n * n;
+        }
+        return size;
+    }
+
+    template <bool Beautify, bool UpdateIndices>
+    static void fill(const Parameters& params, const ShapeOutput& out) {
+        int n = params.cube_segments;
+        int side = n + 1;
+        size_t layer_vertices = static_cast<size_t>(side) * side;
+        // 除最后一层外每层的索引数：x、y 方向各 n * (n+1) 条边，z 方向 (n+1)^2 条边
+        size_t layer_indices = 2 * (2 * static_cast<size_t>(n) * side + layer_vertices);
+        size_t lattice_vertices = layer_vertices * side;
+        size_t lattice_indices = 6 * static_cast<size_t>(n) * layer_vertices;
+
+        // 立方体中心在原点，格点和体心点的坐标对三个轴都相同，各算一次
+        float edge = params.cube_size;
+        float half = edge * 0.5f;
+        std::vector<float> coords(side);
+        std::vector<float> centers(n);
+        for (int i = 0; i < side; ++i) coords[i] = edge * i / n - half;
+        for (int i = 0; i < n; ++i) centers[i] = edge * (i + 0.5f) / n - half;
+
+        auto vertexIndex = [side](int i, int j, int k) {
+            return static_cast<unsigned int>((static_cast<size_t>(k) * side + j) * side + i);
+        };
+
+        size_t min_chunk = std::max<size_t>(1, kMinParallelVertices / layer_vertices);
+        out.forEachRange(side, min_chunk, [&](size_t layer_begin, size_t layer_end) {
+            for (int k = static_cast<int>(layer_begin); k < static_cast<int>(layer_end); ++k) {
+                glm::vec3* vertices = out.vertices + k * layer_vertices;
+                for (int j = 0; j < side; ++j) {
+                    for (int i = 0; i < side; ++i) {
+                        *vertices++ = glm::vec3(coords[i], coords[j], coords[k]);
+                    }
+                }
+
+                if constexpr (UpdateIndices) {
+                    unsigned int* indices = out.indices + k * layer_indices;
+                    // 沿 x 方向
+                    for (int j = 0; j < side; ++j) {
+                        for (int i = 0; i < n; ++i) {
+                            *indices++ = vertexIndex(i, j, k);
+                            *indices++ = vertexIndex(i + 1, j, k);
+                        }
+                    }
+                    // 沿 y 方向
+                    for (int j = 0; j < n; ++j) {
+                        for (int i = 0; i < side; ++i) {
+                            *indices++ = vertexIndex(i, j, k);
+                            *indices++ = vertexIndex(i, j + 1, k);
+                        }
+                    }
+                    // 沿 z 方向连到上一层，最后一层没有
+                    if (k < n) {
+                        for (int j = 0; j < side; ++j) {
+                            for (int i = 0; i < side; ++i) {
+                                *indices++ = vertexIndex(i, j, k);
+                                *indices++ = vertexIndex(i, j, k + 1);
+                            }
+                        }
+                    }
+                }
+
+                // 体心点和第 k 层格点一起生成，最后一层之上没有小立方体
+                if constexpr (Beautify) {
+                    if (k == n) continue;
+                    size_t cell_offset = static_cast<size_t>(k) * n * n;
+                    glm::vec3* cell_vertices = out.vertices + lattice_vertices + cell_offset;
+                    unsigned int* cell_indices = out.indices + lattice_indices + cell_offset * 16;
+                    for (int j = 0; j < n; ++j) {
+                        for (int i = 0; i < n; ++i) {
+                            *cell_vertices++ = glm::vec3(centers[i], centers[j], centers[k]);
+                            if constexpr (UpdateIndices) {
+                                unsigned int center = static_cast<unsigned int>(lattice_vertices + cell_offset + j * n + i);
+                                for (int corner = 0; corner < 8; ++corner) {
+                                    *cell_indices++ = center;
+                                    *cell_indices++ = vertexIndex(i + (corner & 1), j + ((corner >> 1) & 1), k + (corner >> 2));
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    }
+};
+
+// 按形状和美化选项选出对应的编译期实例，调用 visitor(形状类型对象, std::bool_constant<美化>)
+// 新增形状时在这里加一个分支
+template <typename Shape, typename Visitor>
+void dispatchBeautify(const Parameters& params, Visitor& visitor) {
+    if (params.beautify) visitor(Shape(), std::true_type());
+    else visitor(Shape(), std::false_type());
+}
+
+template <typename Visitor>
+bool dispatch(const Parameters& params, Visitor&& visitor) {
+    switch (params.shape) {
+    case ShapeType::TOPOLOGY_2D:
+        dispatchBeautify<Topology2DShape>(params, visitor);
+        return true;
+    case ShapeType::SPHERE:
+        dispatchBeautify<SphereShape>(params, visitor);
+        return true;
+    case ShapeType::TORUS:
+        dispatchBeautify<TorusShape>(params, visitor);
+        return true;
+    case ShapeType::CUBE:
+        dispatchBeautify<CubeShape>(params, visitor);
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+namespace ShapeGenerators {
+
+MeshSize computeSize(const Parameters& params) {
+    MeshSize size;
+    dispatch(params, [&](auto shape, auto beautify) {
+        size = decltype(shape)::template size<decltype(beautify)::value>(params);
+    });
+    return size;
+}
+
+bool generate(const Parameters& params, const ShapeOutput& out, bool positionsOnly) {
+    bool generated = false;
+    dispatch(params, [&](auto shape, auto beautify) {
+        using Shape = decltype(shape);
+        constexpr bool kBeautify = decltype(beautify)::value;
+        if (Shape::template size<kBeautify>(params).vertexCount == 0) return;
+        if (positionsOnly) Shape::template fill<kBeautify, false>(params, out);
+        else Shape::template fill<kBeautify, true>(params, out);
+        generated = true;
+    });
+    return generated;
+}
+
+AngleTable makeRingTable(int count) {
+    AngleTable table;
+    if (copyRingPresets<3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 48, 50, 64>(count, table)) return table;
+
+    std::vector<float> angles(count);
+    for (int i = 0; i < count; ++i) {
+        angles[i] = (float)i / count * 2.0f * glm::pi<float>();
+    }
+    table.build(angles);
+    return table;
+}
+
+std::vector<glm::vec3> makeTopologyUnit(int num_sides, int points_per_sector, float outer_radius) {
+    std::vector<float> unit_angles(points_per_sector);
+    for (int j = 0; j < points_per_sector; ++j) {
+        unit_angles[j] = (j + 1) * (2.0f * glm::pi<float>() / (num_sides * 2)); // 分布在扇区的一半内
+    }
+    AngleTable unit_table;
+    unit_table.build(unit_angles);
+
+    std::vector<glm::vec3> base_unit(points_per_sector);
+    for (int j = 0; j < points_per_sector; ++j) {
+        // 将子结构点放在内部，例如在 0.5 * outer_radius 到 outer_radius 之间
+        // 这里可以调整 `inner_radius` 来控制子结构的大小
+        float inner_radius = outer_radius * (0.5f + 0.5f * (j + 1) / (points_per_sector + 1));
+        float x = inner_radius * unit_table.cosines[j];
+        float y = inner_radius * unit_table.sines[j];
+        base_unit[j] = glm::vec3(x, y, 0.0f);
+    }
+    return base_unit;
+}
+
+void makeSphereLayers(int layers, float radius, std::vector<float>& layer_z, std::vector<float>& layer_radius) {
+    layer_z.resize(2 * layers + 1);
+    layer_radius.resize(2 * layers + 1);
+    for (int j = -layers; j <= layers; ++j) {
+        float height = radius * j / layers;
+        float z = height;
+        layer_z[j + layers] = z;
+        layer_radius[j + layers] = sqrt(radius * radius - z * z);
+    }
+}
+
+std::vector<glm::vec3> makeSphereSpiralUnit(int sectors, int points_per_sector, float radius) {
+    float angleStep = 2.0f * glm::pi<float>() / sectors;
+    int spiral_points = points_per_sector + 1;
+    std::vector<float> spiral_angles(2 * spiral_points);
+    std::vector<float> wave_angles(spiral_points);
+    for (int spiral = 0; spiral <= points_per_sector; ++spiral) {
+        float spiralProgress = static_cast<float>(spiral) / points_per_sector;  // 0到1
+        spiral_angles[spiral] = spiralProgress * angleStep * 0.5f;  // 螺旋角度变化
+        spiral_angles[spiral_points + spiral] = angleStep * 0.5f + spiralProgress * angleStep * 0.5f;  // 从扇面中间开始
+        wave_angles[spiral] = spiralProgress * glm::pi<float>();
+    }
+    AngleTable spiral_table;
+    spiral_table.build(spiral_angles);
+    AngleTable wave_table;
+    wave_table.build(wave_angles);
+
+    std::vector<glm::vec3> spiral_unit(2 * spiral_points);
+    for (int spiral = 0; spiral <= points_per_sector; ++spiral) {
+        float spiralProgress = static_cast<float>(spiral) / points_per_sector;
+        float spiralRadius = radius * spiralProgress;  // 径向距离
+        float spiralZ = radius * wave_table.sines[spiral] * 0.5f;  // z方向螺旋变化
+
+        // 第一条螺旋线在扇面的前一半，第二条在后一半且 z 方向相反
+        spiral_unit[spiral] = glm::vec3(spiralRadius * spiral_table.cosines[spiral],
+            spiralRadius * spiral_table.sines[spiral], spiralZ);
+        spiral_unit[spiral_points + spiral] = glm::vec3(spiralRadius * spiral_table.cosines[spiral_points + spiral],
+            spiralRadius * spiral_table.sines[spiral_points + spiral], -spiralZ);
+    }
+    return spiral_unit;
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+#include "TrigKernel.h"
+
+// 褰㈢姸鐢熸垚鍣#pragma once
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <glm/glm.hpp>
+#include "TopologyGraph.h"
+#include "TrigKernel.h"
+
+// 形状生成器：每种形状是一个类型（见 ShapeGenerators.cpp），美化、是否写索引等模式是模板参数，
+// 入口处按参数选出一个具体的实例，之后的内层循环中没有这些分支
+// 新增形状只需要定义一个形状类型，并在 ShapeGenerators.cpp 的 dispatch 中加一个分支
+
+// 生成器写入的位置和并行方式，由调用方提供
+struct ShapeOutput {
+    // 已经按 computeSize 的数量分配好的顶点和索引数组
+    glm::vec3* vertices = nullptr;
+    unsigned int* indices = nullptr;
+    // 把 [0, count) 按不小于 minChunk 的块分给多个线程执行，各块写入互不重叠的区间
+    std::function<void(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body)> forEachRange;
+};
+
+namespace ShapeGenerators {
+    // 并行生成时每个任务至少处理的顶点数，太小的任务调度开销比计算还大
+    const size_t kMinParallelVertices = 16384;
+
+    // 给定参数下的顶点数和索引数，参数无效时为 0
+    MeshSize computeSize(const Parameters& params);
+
+    // 按 computeSize 的数量和顺序写入顶点和索引；positionsOnly 为 true 时只重写顶点坐标，索引保持不变
+    // 参数无效时不写入任何数据，返回 false
+    bool generate(const Parameters& params, const ShapeOutput& out, bool positionsOnly);
+
+    // 以下几何数据也用于 TopologyGraph::describeSymmetry，保证扇区描述和完整生成的结果一致
+
+    // 等分一圈的角度表，第 i 个角度为 i / count * 2pi；常用的段数直接复制编译期算好的表
+    AngleTable makeRingTable(int count);
+    // 2D 拓扑图扇区 0 内的子结构点，其他扇区的子结构由它旋转得到
+    std::vector<glm::vec3> makeTopologyUnit(int num_sides, int points_per_sector, float outer_radius);
+    // 球体经线上各层的高度和截面半径，所有扇区相同
+    void makeSphereLayers(int layers, float radius, std::vector<float>& layer_z, std::vector<float>& layer_radius);
+    // 球体扇区 0 内的两条螺旋线，前 points_per_sector + 1 个点是第一条，其余是第二条
+    std::vector<glm::vec3> makeSphereSpiralUnit(int sectors, int points_per_sector, float radius);
+}
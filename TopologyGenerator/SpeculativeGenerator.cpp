@@ -0,0 +1,198 @@
+#include "SpeculativeGenerator.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+// 闃叉#include "SpeculativeGenerator.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+// 防止 windows.h 定义 min 和 max 宏
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool sameGraph(const Parameters& a, const Parameters& b) {
+    return TopologyGraph::classifyChange(a, b) == GraphChange::NONE;
+}
+
+// 预测只是锦上添花，和渲染线程、主生成器抢 CPU 时让它们优先
+void lowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+    // Linux 的 nice 值按线程生效
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+}
+
+}
+
+SpeculativeGenerator::~SpeculativeGenerator() {
+    stopWorkers();
+}
+
+void SpeculativeGenerator::setThreadCount(unsigned int count) {
+    if (count == m_workers.size()) return;
+    cancel();
+    stopWorkers();
+    for (unsigned int i = 0; i < count; ++i) {
+        m_workers.emplace_back(&SpeculativeGenerator::workerLoop, this);
+    }
+}
+
+void SpeculativeGenerator::setMaxBytes(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxBytes = bytes;
+    }
+    m_jobCv.notify_all();
+}
+
+size_t SpeculativeGenerator::getMaxBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxBytes;
+}
+
+size_t SpeculativeGenerator::estimateBytes(const Parameters& params) {
+    MeshSize size = TopologyGraph::computeSize(params);
+    size_t bytes = size.vertexCount * sizeof(glm::vec3) + size.indexCount * sizeof(unsigned int);
+    if (params.position_format != PositionFormat::FLOAT32) bytes += size.vertexCount * 4 * sizeof(uint16_t);
+    if (params.short_indices && size.vertexCount <= 65536) bytes += size.indexCount * sizeof(uint16_t);
+    return bytes;
+}
+
+bool SpeculativeGenerator::isKnown(const Parameters& params) const {
+    for (const auto& job : m_running) {
+        if (!job->cancel && sameGraph(job->params, params)) return true;
+    }
+    for (const Result& result : m_results) {
+        if (sameGraph(result.graph.getParameters(), params)) return true;
+    }
+    return false;
+}
+
+void SpeculativeGenerator::speculate(const std::vector<Parameters>& candidates) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        // 不再需要的生成尽快中止，把 CPU 和内存让给新的候选
+        for (const auto& job : m_running) {
+            if (job->cancel) continue;
+            bool wanted = std::any_of(candidates.begin(), candidates.end(),
+                [&job](const Parameters& params) { return sameGraph(job->params, params); });
+            if (!wanted) {
+                job->cancel = true;
+                ++m_stats.cancelled;
+            }
+        }
+        for (const Parameters& params : candidates) {
+            if (isKnown(params)) continue;
+            auto job = std::make_shared<Job>();
+            job->params = params;
+            job->bytes = estimateBytes(params);
+            if (job->bytes > m_maxBytes) {
+                ++m_stats.skipped;
+                continue;
+            }
+            m_queue.push_back(std::move(job));
+        }
+    }
+    m_jobCv.notify_all();
+}
+
+void SpeculativeGenerator::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        for (const auto& job : m_running) {
+            if (job->cancel) continue;
+            job->cancel = true;
+            ++m_stats.cancelled;
+        }
+        for (const Result& result : m_results) m_reservedBytes -= result.bytes;
+        m_results.clear();
+    }
+    m_jobCv.notify_all();
+}
+
+bool SpeculativeGenerator::fetch(TopologyGraph& graph) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_results.empty()) return false;
+        graph = std::move(m_results.front().graph);
+        m_reservedBytes -= m_results.front().bytes;
+        m_results.pop_front();
+    }
+    // 腾出的内存预算可能让排队的候选开始生成
+    m_jobCv.notify_all();
+    return true;
+}
+
+SpeculativeGenerator::Stats SpeculativeGenerator::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void SpeculativeGenerator::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        for (const auto& job : m_running) job->cancel = true;
+    }
+    m_jobCv.notify_all();
+    for (std::thread& worker : m_workers) worker.join();
+    m_workers.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = false;
+}
+
+void SpeculativeGenerator::workerLoop() {
+    lowerThreadPriority();
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // 按候选顺序生成，排在最前的放不进内存预算时等已有的结果被取走
+            m_jobCv.wait(lock, [this] {
+                return m_stop || (!m_queue.empty() && m_reservedBytes + m_queue.front()->bytes <= m_maxBytes);
+            });
+            if (m_stop) return;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_running.push_back(job);
+            m_reservedBytes += job->bytes;
+            ++m_stats.started;
+        }
+
+        TopologyGraph graph;
+        graph.setCancelFlag(&job->cancel);
+        graph.generate(job->params);
+        graph.setCancelFlag(nullptr);
+
+        bool ready = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running.erase(std::find(m_running.begin(), m_running.end(), job));
+            if (job->cancel || !graph.hasGenerated()) {
+                m_reservedBytes -= job->bytes;
+            }
+            else {
+                m_results.push_back(Result{ std::move(graph), job->bytes });
+                ++m_stats.completed;
+                ready = true;
+            }
+        }
+        // 释放的预算可能让其他线程开始下一个候选
+        if (!ready) m_jobCv.notify_all();
+        if (ready && m_readyCallback) m_readyCallback();
+    }
+}
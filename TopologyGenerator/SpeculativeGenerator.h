@@ -0,0 +1,101 @@
+#pragma once
+#include "TopologyGraph.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cstddef>
+
+// 棰勬祴鐢熸垚鍣#pragma once
+#include "TopologyGraph.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cstddef>
+
+// 预测生成器：拖动滑动条时在低优先级的后台线程里提前生成相邻的参数值，滑动条到达时结果已经在缓存里
+// 每个线程单线程生成，不占用主生成器的线程池；线程数就是 CPU 预算，内存预算限制排队、生成中和待取走的图形总大小
+// 候选列表随时可以整体替换或取消，不再需要的生成会尽快中止
+class SpeculativeGenerator {
+public:
+    SpeculativeGenerator() = default;
+    ~SpeculativeGenerator();
+
+    SpeculativeGenerator(const SpeculativeGenerator&) = delete;
+    SpeculativeGenerator& operator=(const SpeculativeGenerator&) = delete;
+
+    // 后台线程数，0 表示关闭预测；线程数改变时先取消全部工作。只能在渲染线程调用
+    void setThreadCount(unsigned int count);
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+    // 内存预算（字节）：单个候选的估计大小超过它时不生成，所有未取走的结果加起来也不超过它
+    void setMaxBytes(size_t bytes);
+    size_t getMaxBytes() const;
+
+    // 用新的候选列表替换旧的，排在前面的先生成；正在生成但不在新列表中的候选会被取消
+    // 已经完成还没取走的结果保留
+    void speculate(const std::vector<Parameters>& candidates);
+
+    // 丢弃全部候选和还没取走的结果，取消正在进行的生成
+    void cancel();
+
+    // 取走一个完成的结果，没有时返回 false
+    bool fetch(TopologyGraph& graph);
+
+    // 有新结果可以取时在工作线程调用，必须在 setThreadCount 之前设置
+    void setReadyCallback(std::function<void()> callback) { m_readyCallback = std::move(callback); }
+
+    // 按公式估计一个图形占用的字节数，开启焊接时是焊接前的上限
+    static size_t estimateBytes(const Parameters& params);
+
+    struct Stats {
+        size_t started = 0;
+        size_t completed = 0;
+        size_t cancelled = 0;
+        // 超出内存预算没有生成的候选数
+        size_t skipped = 0;
+    };
+    Stats getStats() const;
+
+private:
+    // 一次生成：每个任务有自己的取消标志，替换候选列表时只取消不再需要的任务
+    struct Job {
+        Parameters params;
+        size_t bytes = 0;
+        std::atomic<bool> cancel{ false };
+    };
+
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobCv;
+    std::deque<std::shared_ptr<Job>> m_queue;
+    std::vector<std::shared_ptr<Job>> m_running;
+    // 完成还没取走的结果及其估计大小
+    struct Result {
+        TopologyGraph graph;
+        size_t bytes = 0;
+    };
+    std::deque<Result> m_results;
+    // 生成中和待取走的结果的估计大小
+    size_t m_reservedBytes = 0;
+    size_t m_maxBytes = 256u << 20;
+    bool m_stop = false;
+    Stats m_stats;
+
+    std::function<void()> m_readyCallback;
+
+    void stopWorkers();
+    void workerLoop();
+    // 参数是否已经在排队、生成中或待取走，调用时需持有 m_mutex
+    bool isKnown(const Parameters& params) const;
+};
@@ -0,0 +1,215 @@
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 鎸佷箙鏄犲皠妯″紡鐨勬#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 持久映射模式的段数：一段给 GPU 读，一段给 CPU 写，再留一段余量避免等待栅栏
+const size_t kRingRegions = 3;
+
+const uint64_t kHashPrime = 0x9E3779B97F4A7C15ull;
+
+// 四路交错的乘法混合哈希，每一步都是可逆变换，任何一个字不同都会改变结果
+uint64_t hashBlock(const unsigned char* data, size_t bytes) {
+    uint64_t lanes[4] = { bytes, bytes ^ 0x5555555555555555ull, bytes ^ 0xAAAAAAAAAAAAAAAAull, ~bytes };
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, data + i + k * 8, sizeof(word));
+            lanes[k] = (lanes[k] ^ word) * kHashPrime;
+            lanes[k] ^= lanes[k] >> 29;
+        }
+    }
+    for (; i < bytes; ++i) {
+        lanes[0] = (lanes[0] ^ data[i]) * kHashPrime;
+        lanes[0] ^= lanes[0] >> 29;
+    }
+    uint64_t hash = lanes[0];
+    for (int k = 1; k < 4; ++k) {
+        hash = (hash ^ lanes[k]) * kHashPrime;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+}
+
+BufferStorageProc StreamBuffer::loadBufferStorage(GLADloadproc loader) {
+    bool supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4) ||
+        hasExtension("GL_ARB_buffer_storage");
+    if (!supported) return nullptr;
+    return reinterpret_cast<BufferStorageProc>(loader("glBufferStorage"));
+}
+
+void StreamBuffer::init(GLenum target, BufferStorageProc bufferStorage) {
+    m_target = target;
+    m_bufferStorage = bufferStorage;
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(m_target, m_buffer);
+    m_regions.assign(1, Region());
+    m_current = 0;
+}
+
+void StreamBuffer::destroy() {
+    for (auto& region : m_regions) {
+        if (region.fence) glDeleteSync(region.fence);
+        region.fence = nullptr;
+    }
+    if (m_buffer) {
+        // 删除缓冲区会自动解除映射
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+    m_mapped = nullptr;
+    m_capacity = 0;
+    m_regions.clear();
+}
+
+void StreamBuffer::grow(size_t bytes) {
+    size_t capacity = std::max(bytes, m_capacity + m_capacity / 2);
+    capacity = (capacity + kBlockSize - 1) / kBlockSize * kBlockSize;
+
+    if (m_bufferStorage) {
+        // 不可变存储不能重新分配，只能换一个新的缓冲区对象；GPU 还在用的旧对象会由驱动延迟释放
+        destroy();
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(m_target, m_buffer);
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        m_bufferStorage(m_target, static_cast<GLsizeiptr>(capacity * kRingRegions), nullptr, flags);
+        m_mapped = static_cast<unsigned char*>(glMapBufferRange(m_target, 0, static_cast<GLsizeiptr>(capacity * kRingRegions), flags));
+        if (m_mapped) {
+            m_regions.assign(kRingRegions, Region());
+            for (size_t i = 0; i < kRingRegions; ++i) m_regions[i].offset = i * capacity;
+            m_current = 0;
+            m_capacity = capacity;
+            return;
+        }
+
+        // 映射失败时退回普通缓冲区
+        glDeleteBuffers(1, &m_buffer);
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(m_target, m_buffer);
+        m_bufferStorage = nullptr;
+    }
+
+    glBufferData(m_target, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+    m_regions.assign(1, Region());
+    m_current = 0;
+    m_capacity = capacity;
+}
+
+void StreamBuffer::hashBlocks(const unsigned char* data, size_t bytes) {
+    size_t blocks = (bytes + kBlockSize - 1) / kBlockSize;
+    m_newHashes.resize(blocks);
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            size_t offset = b * kBlockSize;
+            m_newHashes[b] = hashBlock(data + offset, std::min(kBlockSize, bytes - offset));
+        }
+    };
+    if (m_threadPool && blocks > 64) {
+        m_threadPool->parallelFor(0, blocks, 16, body);
+    }
+    else {
+        body(0, blocks);
+    }
+}
+
+void StreamBuffer::waitFence(Region& region) {
+    if (!region.fence) return;
+    // 一般已经是两帧之前的栅栏，不会真正等待
+    while (glClientWaitSync(region.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {
+    }
+    glDeleteSync(region.fence);
+    region.fence = nullptr;
+}
+
+size_t StreamBuffer::update(const void* data, size_t bytes) {
+    m_lastUploadBytes = 0;
+    if (bytes > m_capacity) grow(bytes);
+
+    const unsigned char* source = static_cast<const unsigned char*>(data);
+    hashBlocks(source, bytes);
+    size_t blocks = m_newHashes.size();
+
+    // 持久映射模式写入下一段，不影响 GPU 正在读取的当前段
+    size_t target_region = m_mapped ? (m_current + 1) % m_regions.size() : 0;
+    Region& region = m_regions[target_region];
+
+    // 找出和这一段现有内容不同的块
+    auto isDirty = [&](size_t b) {
+        return b >= region.blockHashes.size() || region.blockHashes[b] != m_newHashes[b];
+    };
+    size_t dirty_bytes = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        if (isDirty(b)) dirty_bytes += std::min(kBlockSize, bytes - b * kBlockSize);
+    }
+
+    if (m_mapped) {
+        waitFence(region);
+        for (size_t b = 0; b < blocks; ++b) {
+            if (!isDirty(b)) continue;
+            size_t offset = b * kBlockSize;
+            std::memcpy(m_mapped + region.offset + offset, source + offset, std::min(kBlockSize, bytes - offset));
+        }
+        m_current = target_region;
+    }
+    else if (dirty_bytes > 0) {
+        glBindBuffer(m_target, m_buffer);
+        if (dirty_bytes * 2 > bytes) {
+            // 大部分内容都变了：孤立旧存储，驱动为新内容分配新内存，不用等待还在使用旧内容的绘制
+            glBufferData(m_target, static_cast<GLsizeiptr>(m_capacity), nullptr, GL_DYNAMIC_DRAW);
+            void* mapped = glMapBufferRange(m_target, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (mapped) {
+                std::memcpy(mapped, source, bytes);
+            }
+            if (!mapped || !glUnmapBuffer(m_target)) {
+                glBufferSubData(m_target, 0, static_cast<GLsizeiptr>(bytes), source);
+            }
+            dirty_bytes = bytes;
+        }
+        else {
+            // 只上传变化的块，相邻的脏块合并成一次调用
+            size_t b = 0;
+            while (b < blocks) {
+                if (!isDirty(b)) { ++b; continue; }
+                size_t run_end = b + 1;
+                while (run_end < blocks && isDirty(run_end)) ++run_end;
+                size_t offset = b * kBlockSize;
+                size_t length = std::min(run_end * kBlockSize, bytes) - offset;
+                glBufferSubData(m_target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(length), source + offset);
+                b = run_end;
+            }
+        }
+    }
+
+    region.blockHashes.swap(m_newHashes);
+    m_lastUploadBytes = dirty_bytes;
+    return dirty_bytes;
+}
+
+void StreamBuffer::markInUse() {
+    if (!m_mapped) return;
+    Region& region = m_regions[m_current];
+    if (region.fence) glDeleteSync(region.fence);
+    region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+// glad 鍙#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+// glad 只生成了 OpenGL 3.3 核心模式，ARB_buffer_storage 的常量和函数需要自己补上
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+using BufferStorageProc = void (APIENTRYP)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+// 流式上传缓冲区：容量只增不减，每次更新只上传内容发生变化的块
+// 有 glBufferStorage 时使用持久映射的三段环形缓冲区，CPU 写下一段时 GPU 可以继续读当前段；
+// 没有时使用普通缓冲区，变化少时用 glBufferSubData 只更新变化的区间，变化多时先孤立旧存储再整体写入
+// 内容是否变化按固定大小的块比较哈希值，每一段都记录自己保存的内容，所以环形缓冲区的各段各自只补差异
+class StreamBuffer {
+public:
+    StreamBuffer() = default;
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // 检测并加载 glBufferStorage（OpenGL 4.4 或 ARB_buffer_storage），不支持时返回 nullptr
+    static BufferStorageProc loadBufferStorage(GLADloadproc loader);
+
+    // 创建缓冲区对象，bufferStorage 为 nullptr 时使用普通缓冲区
+    void init(GLenum target, BufferStorageProc bufferStorage = nullptr);
+    // 释放 GL 资源，必须在 GL 上下文销毁之前调用
+    void destroy();
+
+    // 计算块哈希时使用的线程池，可以为 nullptr
+    void setThreadPool(ThreadPool* pool) { m_threadPool = pool; }
+
+    // 用 data 的内容替换缓冲区内容，返回实际上传的字节数
+    // 会把缓冲区绑定到自己的目标上；索引缓冲区更新前应先绑定要使用它的 VAO
+    // 扩容时缓冲区对象可能重建，调用后应重新用 getBuffer() 设置顶点属性和索引绑定
+    size_t update(const void* data, size_t bytes);
+
+    // 在使用当前段的绘制命令之后调用，环形模式下插入栅栏，保证这一段在 GPU 用完之前不会被覆盖
+    void markInUse();
+
+    GLuint getBuffer() const { return m_buffer; }
+    // 当前内容在缓冲区中的字节偏移，绘制时换算成起始顶点或索引偏移
+    size_t getOffset() const { return m_regions.empty() ? 0 : m_regions[m_current].offset; }
+    // 每一段的容量（字节）
+    size_t getCapacity() const { return m_capacity; }
+    bool isPersistent() const { return m_mapped != nullptr; }
+    size_t getLastUploadBytes() const { return m_lastUploadBytes; }
+
+    // 比较内容的块大小，是 12（vec3）和 4（索引）的公倍数，保证环形缓冲区每一段的起点都能整除元素大小
+    static const size_t kBlockSize = 12288;
+
+private:
+    // 环形缓冲区中的一段（普通模式只有一段）
+    struct Region {
+        size_t offset = 0;
+        // 这一段当前内容的块哈希，长度为有效块数
+        std::vector<uint64_t> blockHashes;
+        GLsync fence = nullptr;
+    };
+
+    GLenum m_target = GL_ARRAY_BUFFER;
+    GLuint m_buffer = 0;
+    BufferStorageProc m_bufferStorage = nullptr;
+    ThreadPool* m_threadPool = nullptr;
+
+    size_t m_capacity = 0;
+    unsigned char* m_mapped = nullptr;
+    std::vector<Region> m_regions;
+    size_t m_current = 0;
+    size_t m_lastUploadBytes = 0;
+
+    // 新内容的块哈希，和各段保存的哈希比较后得到需要上传的块
+    std::vector<uint64_t> m_newHashes;
+
+    // 按需要的字节数重建存储，新容量至少是旧容量的 1.5 倍
+    void grow(size_t bytes);
+    void hashBlocks(const unsigned char* data, size_t bytes);
+    void waitFence(Region& region);
+};
@@ -0,0 +1,164 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskCv.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+        ++m_pending;
+    }
+    m_taskCv.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this] { return m_pending == 0; });
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t minChunk,
+    const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin) return;
+
+    size_t total = end - begin;
+    minChunk = std::max<size_t>(1, minChunk);
+
+    // 姣忎釜绾跨▼澶х害鍒嗗埌 4 鍧楋紝鏂逛究璐熻浇鍧囪　
+    size_t chunkCount = std::min(total / minChunk, static_cast<size_t>(m_workers.size() + 1) * 4);
+    if (chunkCount <= 1) {
+        body(begin, end);
+        return;
+    }
+    size_t chunkSize = (total + chunkCount - 1) / chunkCount;
+    chunkCount = (total + chunkSize - 1) / chunkSize;
+
+    // 鍚勭嚎绋嬮€氳繃鍘熷瓙璁℃暟鍣ㄩ#include "ThreadPool.h"
+#include <algorithm>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskCv.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+        ++m_pending;
+    }
+    m_taskCv.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this] { return m_pending == 0; });
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t minChunk,
+    const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin) return;
+
+    size_t total = end - begin;
+    minChunk = std::max<size_t>(1, minChunk);
+
+    // 每个线程大约分到 4 块，方便负载均衡
+    size_t chunkCount = std::min(total / minChunk, static_cast<size_t>(m_workers.size() + 1) * 4);
+    if (chunkCount <= 1) {
+        body(begin, end);
+        return;
+    }
+    size_t chunkSize = (total + chunkCount - 1) / chunkCount;
+    chunkCount = (total + chunkSize - 1) / chunkSize;
+
+    // 各线程通过原子计数器领取块，领到即执行，不存在排队等待
+    struct SharedState {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> finished{ 0 };
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<SharedState>();
+
+    auto runChunks = [state, begin, end, chunkSize, chunkCount, &body]() {
+        for (;;) {
+            size_t chunk = state->next.fetch_add(1);
+            if (chunk >= chunkCount) return;
+            size_t chunkBegin = begin + chunk * chunkSize;
+            size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+            body(chunkBegin, chunkEnd);
+            if (state->finished.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    // 帮手任务可能在 parallelFor 返回后才被调度到，此时已领不到块，不会再访问 body
+    size_t helpers = std::min(chunkCount - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        submit(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->finished.load() == chunkCount; });
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskCv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+            if (m_pending == 0) m_doneCv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// 绠€鍗曠殑绾跨▼姹狅紝鎵归噺鐢熸垚鍜屽苟琛岃#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// 简单的线程池，批量生成和并行计算共用
+class ThreadPool {
+public:
+    // 线程数为 0 时使用全部硬件线程
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交一个任务
+    void submit(std::function<void()> task);
+
+    // 等待所有已提交的任务完成
+    void wait();
+
+    // 把 [begin, end) 切成若干块并行执行 body(chunkBegin, chunkEnd)
+    // 调用线程也会参与计算，所以在线程池任务内部调用也不会死锁
+    void parallelFor(size_t begin, size_t end, size_t minChunk,
+        const std::function<void(size_t, size_t)>& body);
+
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskCv;
+    std::condition_variable m_doneCv;
+
+    // 正在执行和排队中的任务总数
+    size_t m_pending = 0;
+    bool m_stop = false;
+
+    void workerLoop();
+};
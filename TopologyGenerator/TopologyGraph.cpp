@@ -1,338 +1,572 @@
 #include "TopologyGraph.h"
+#include "ThreadPool.h"
+#include "ShapeGenerators.h"
+#include "MeshCache.h"
 #include <cmath>
-#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <chrono>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+using ShapeGenerators::kMinParallelVertices;
+
+// 鎶婃暟缁勮皟鏁村埌鎸囧畾澶у皬锛氬#include "TopologyGraph.h"
+#include "ThreadPool.h"
+#include "ShapeGenerators.h"
+#include "MeshCache.h"
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <chrono>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+using ShapeGenerators::kMinParallelVertices;
+
+// 把数组调整到指定大小：容量不够时先释放旧内存再一次性分配，避免新旧两块内存同时存在
+template <typename T>
+void resizeStorage(std::vector<T>& storage, size_t size) {
+    if (storage.capacity() < size) {
+        std::vector<T>().swap(storage);
+    }
+    storage.resize(size);
+}
 
-void TopologyGraph::generate(const Parameters& params) {
-	// 娓呯┖鐜版湁鏁版嵁
-    m_vertices.clear();
-    m_indices.clear();
+// 16 位最多能表示的顶点数
+const size_t kMaxShortIndexVertices = 65536;
+
+// 焊接时判断两点重合的容差，相对于所有坐标分量绝对值的最大值
+const float kWeldTolerance = 1e-5f;
+// 空间哈希的格子边长是容差的若干倍，格子越大，容差范围跨越格子边界需要多查的格子越少
+const float kWeldCellScale = 32.0f;
+// 提前预取哈希表槽位的距离（元素个数）
+const size_t kWeldPrefetchDistance = 32;
+// 开放寻址哈希表中的空槽
+const uint32_t kEmptySlot = 0xFFFFFFFFu;
+const uint64_t kEmptyEdge = ~0ull;
+
+// splitmix64 的混合函数，把格子坐标和边的两个端点打散到整个 64 位
+uint64_t mixHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
 
-	// 鏍规嵁閫夋嫨鐨勫舰鐘剁被鍨嬭皟鐢ㄧ浉搴旂殑鐢熸垚鍑芥暟
-    switch (params.shape) {
-    case ShapeType::TOPOLOGY_2D:
-        generate2DTopology(params.topology_sides, params.topology_points_per_sector,params.beautify);
-        break;
-    case ShapeType::SPHERE:
-        generateSphere(params.sphere_sectors, params.sphere_points_per_sector, params.sphere_layers, params.beautify);
-        break;
-    case ShapeType::TORUS:
-        generateTorus(params.torus_main_segments, params.torus_tube_segments, params.torus_main_radius, params.torus_tube_radius, params.beautify);
-        break;
+void prefetchRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+uint64_t cellHash(int64_t x, int64_t y, int64_t z) {
+    return mixHash(static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ull ^
+        static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4Full ^
+        static_cast<uint64_t>(z) * 0x165667B19E3779F9ull);
+}
+
+// 线性探测哈希表的槽数：2 的幂，装载率不超过 2/3
+size_t hashTableSize(size_t count) {
+    size_t size = 16;
+    while (size < count + count / 2) size <<= 1;
+    return size;
+}
+
+// 32 位浮点转 16 位半精度浮点，舍入到最近的偶数，超出范围时变为无穷大
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t abs_bits = bits & 0x7FFFFFFFu;
+
+    // 无穷大和 NaN
+    if (abs_bits >= 0x7F800000u) return static_cast<uint16_t>(sign | 0x7C00u | (abs_bits > 0x7F800000u ? 0x200u : 0u));
+    // 大于等于 65520 时舍入后超出半精度范围
+    if (abs_bits >= 0x477FF000u) return static_cast<uint16_t>(sign | 0x7C00u);
+
+    // 小于 2^-14 时是半精度的非规格化数，尾数为 value / 2^-24
+    if (abs_bits < 0x38800000u) {
+        if (abs_bits < 0x33000000u) return static_cast<uint16_t>(sign);
+        uint32_t exponent = abs_bits >> 23;
+        uint32_t mantissa = (abs_bits & 0x7FFFFFu) | 0x800000u;
+        uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) ++half;
+        return static_cast<uint16_t>(sign | half);
     }
+
+    // 规格化数：指数偏移从 127 改为 15，尾数保留高 10 位（进位会自然进到指数）
+    uint32_t half = (abs_bits - 0x38000000u) >> 13;
+    uint32_t remainder = abs_bits & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1))) ++half;
+    return static_cast<uint16_t>(sign | half);
 }
 
-void TopologyGraph::generate2DTopology(int num_sides, int points_per_sector,bool beautify) {
-	// 鍩烘湰鍙傛暟妫€鏌#include "TopologyGraph.h"
-#include <cmath>
-#include <glm/gtc/constants.hpp>
+// 按缩放把坐标分量量化为 16 位有符号归一化整数，GPU 解码为 q / 32767
+uint16_t floatToSnorm16(float value, float inv_scale) {
+    float q = std::round(value * inv_scale * 32767.0f);
+    q = std::max(-32767.0f, std::min(32767.0f, q));
+    return static_cast<uint16_t>(static_cast<int16_t>(q));
+}
 
-void TopologyGraph::generate(const Parameters& params) {
-	// 清空现有数据
-    m_vertices.clear();
-    m_indices.clear();
+}
 
-	// 根据选择的形状类型调用相应的生成函数
-    switch (params.shape) {
+GraphChange TopologyGraph::generate(const Parameters& params) {
+    GraphChange change = m_hasGenerated ? classifyChange(m_generatedParams, params) : GraphChange::TOPOLOGY;
+    if (change == GraphChange::NONE) return change;
+    m_generatedParams = params;
+    m_hasGenerated = true;
+
+    // 命中磁盘缓存时直接映射文件，生成用的数组也一并释放
+    if (m_meshCache) {
+        std::shared_ptr<const CachedMesh> cached = m_meshCache->load(params);
+        if (cached) {
+            m_cachedMesh = std::move(cached);
+            std::vector<glm::vec3>().swap(m_vertices);
+            std::vector<unsigned int>().swap(m_indices);
+            encodeOutput(params, change);
+            return change;
+        }
+    }
+    auto start_time = std::chrono::steady_clock::now();
+
+    // 拓扑不变时顶点和索引数组的大小和内容布局都不变，原地重写顶点坐标即可
+    MeshSize size = computeSize(params);
+    if (change == GraphChange::POSITIONS) {
+        detachCachedMesh();
+        // 只更新坐标时数组必须已经是当前参数对应的大小
+        if (m_vertices.size() == size.vertexCount && m_indices.size() == size.indexCount) fillShape(params, true);
+    }
+    else {
+        // 清空现有数据，一次性分配好全部存储，生成器按计算好的位置直接写入
+        m_cachedMesh.reset();
+        m_vertices.clear();
+        m_indices.clear();
+        resizeStorage(m_vertices, size.vertexCount);
+        resizeStorage(m_indices, size.indexCount);
+        fillShape(params, false);
+        if (params.weld_vertices && !isCancelled()) weldVertices();
+    }
+
+    // 被取消时数据不完整，不能写入缓存；写文件交给缓存的后台线程，不推迟这次结果的发布
+    if (m_meshCache && !isCancelled()) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        if (seconds >= m_meshCache->getMinGenerateSeconds()) m_meshCache->storeAsync(params, m_vertices, m_indices);
+    }
+    encodeOutput(params, change);
+    if (isCancelled()) m_hasGenerated = false;
+    return change;
+}
+
+GraphChange TopologyGraph::classifyChange(const Parameters& before, const Parameters& after) {
+    if (before.shape != after.shape || before.beautify != after.beautify) return GraphChange::TOPOLOGY;
+    // 输出编码变化时缓冲区格式也变了，按整体重建处理
+    if (before.position_format != after.position_format || before.short_indices != after.short_indices) return GraphChange::TOPOLOGY;
+    if (before.weld_vertices != after.weld_vertices) return GraphChange::TOPOLOGY;
+
+    switch (after.shape) {
     case ShapeType::TOPOLOGY_2D:
-        generate2DTopology(params.topology_sides, params.topology_points_per_sector,params.beautify);
-        break;
+        if (before.topology_sides != after.topology_sides ||
+            before.topology_points_per_sector != after.topology_points_per_sector) return GraphChange::TOPOLOGY;
+        return GraphChange::NONE;
     case ShapeType::SPHERE:
-        generateSphere(params.sphere_sectors, params.sphere_points_per_sector, params.sphere_layers, params.beautify);
-        break;
+        if (before.sphere_sectors != after.sphere_sectors ||
+            before.sphere_points_per_sector != after.sphere_points_per_sector ||
+            before.sphere_layers != after.sphere_layers) return GraphChange::TOPOLOGY;
+        return GraphChange::NONE;
     case ShapeType::TORUS:
-        generateTorus(params.torus_main_segments, params.torus_tube_segments, params.torus_main_radius, params.torus_tube_radius, params.beautify);
-        break;
+        if (before.torus_main_segments != after.torus_main_segments ||
+            before.torus_tube_segments != after.torus_tube_segments) return GraphChange::TOPOLOGY;
+        // 半径只影响顶点坐标；焊接后的顶点和索引已经不是生成时的布局，而且哪些点重合也和半径有关，只能整体重建
+        if (before.torus_main_radius != after.torus_main_radius ||
+            before.torus_tube_radius != after.torus_tube_radius) return after.weld_vertices ? GraphChange::TOPOLOGY : GraphChange::POSITIONS;
+        return GraphChange::NONE;
+    case ShapeType::CUBE:
+        if (before.cube_segments != after.cube_segments) return GraphChange::TOPOLOGY;
+        // 棱长和圆环的半径一样只影响顶点坐标
+        if (before.cube_size != after.cube_size) return after.weld_vertices ? GraphChange::TOPOLOGY : GraphChange::POSITIONS;
+        return GraphChange::NONE;
+    default:
+        return GraphChange::NONE;
     }
 }
 
-void TopologyGraph::generate2DTopology(int num_sides, int points_per_sector,bool beautify) {
-	// 基本参数检查
-    if (num_sides < 3 || points_per_sector < 1) return;
+ArrayView<glm::vec3> TopologyGraph::getVertices() const {
+    if (m_cachedMesh) return ArrayView<glm::vec3>(m_cachedMesh->getVertices(), m_cachedMesh->getVertexCount());
+    return m_vertices;
+}
 
-	// 圆环半径（正多边形的点都在这个圆环上）
-    float outer_radius = 1.0f;
+ArrayView<unsigned int> TopologyGraph::getIndices() const {
+    if (m_cachedMesh) return ArrayView<unsigned int>(m_cachedMesh->getIndices(), m_cachedMesh->getIndexCount());
+    return m_indices;
+}
 
-    // 添加中心点
-    m_vertices.emplace_back(0.0f, 0.0f, 0.0f);
+void TopologyGraph::detachCachedMesh() {
+    if (!m_cachedMesh) return;
+    const CachedMesh& cached = *m_cachedMesh;
+    resizeStorage(m_vertices, cached.getVertexCount());
+    resizeStorage(m_indices, cached.getIndexCount());
+    std::copy(cached.getVertices(), cached.getVertices() + cached.getVertexCount(), m_vertices.begin());
+    std::copy(cached.getIndices(), cached.getIndices() + cached.getIndexCount(), m_indices.begin());
+    m_cachedMesh.reset();
+}
 
-    // 添加 N 边形的 N 个外圈顶点 (顶点 1 到 N)
-    for (int i = 0; i < num_sides; ++i) {
-        float angle = 2.0f * glm::pi<float>() * i / num_sides;
-        float x = outer_radius * cos(angle);
-        float y = outer_radius * sin(angle);
-        m_vertices.emplace_back(x, y, 0.0f);
+MeshSize TopologyGraph::computeSize(const Parameters& params) {
+    return ShapeGenerators::computeSize(params);
+}
+
+Parameters TopologyGraph::makePreviewParameters(const Parameters& params, size_t maxVertices) {
+    if (computeSize(params).vertexCount <= maxVertices) return params;
+
+    // 下限和界面上滑动条的下限相同
+    auto reduce = [](int value, int k, int minimum) { return std::max(minimum, (value + k - 1) / k); };
+    Parameters preview = params;
+    for (int k = 2; ; ++k) {
+        preview = params;
+        bool at_minimum = false;
+        switch (params.shape) {
+        case ShapeType::TOPOLOGY_2D:
+            preview.topology_sides = reduce(params.topology_sides, k, 3);
+            preview.topology_points_per_sector = reduce(params.topology_points_per_sector, k, 1);
+            at_minimum = preview.topology_sides == 3 && preview.topology_points_per_sector == 1;
+            break;
+        case ShapeType::SPHERE:
+            preview.sphere_sectors = reduce(params.sphere_sectors, k, 3);
+            preview.sphere_points_per_sector = reduce(params.sphere_points_per_sector, k, 1);
+            preview.sphere_layers = reduce(params.sphere_layers, k, 2);
+            at_minimum = preview.sphere_sectors == 3 && preview.sphere_points_per_sector == 1 && preview.sphere_layers == 2;
+            break;
+        case ShapeType::TORUS:
+            preview.torus_main_segments = reduce(params.torus_main_segments, k, 4);
+            preview.torus_tube_segments = reduce(params.torus_tube_segments, k, 3);
+            at_minimum = preview.torus_main_segments == 4 && preview.torus_tube_segments == 3;
+            break;
+        case ShapeType::CUBE:
+            preview.cube_segments = reduce(params.cube_segments, k, 1);
+            at_minimum = preview.cube_segments == 1;
+            break;
+        default:
+            return params;
+        }
+        if (at_minimum || computeSize(preview).vertexCount <= maxVertices) return preview;
     }
+}
 
-    // 生成索引
-    int base_vertex_offset = 1 + num_sides; // 中心点(0) + 外圈点(num_sides) 之后的第一个顶点索引
-    int vertices_per_sector = points_per_sector;
+void TopologyGraph::fillShape(const Parameters& params, bool positionsOnly) {
+    ShapeOutput out;
+    out.vertices = m_vertices.data();
+    out.indices = m_indices.data();
+    out.forEachRange = [this](size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body) {
+        forEachRange(count, minChunk, body);
+    };
+    ShapeGenerators::generate(params, out, positionsOnly);
+}
 
-    // 连接中心点到所有外圈顶点
-    for (int i = 1; i <= num_sides; ++i) {
-        m_indices.push_back(0); // 中心点
-        m_indices.push_back(i); // 外圈顶点
-    }
+bool TopologyGraph::describeSymmetry(const Parameters& params, SymmetricMesh& mesh) {
+    mesh = SymmetricMesh();
 
-    // 连接外圈顶点形成多边形
-    for (int i = 1; i <= num_sides; ++i) {
-        m_indices.push_back(i);
-        int next_vertex_index = (i == num_sides) ? 1 : i + 1;
-        m_indices.push_back(next_vertex_index);
-    }
+    if (params.shape == ShapeType::TOPOLOGY_2D) {
+        int num_sides = params.topology_sides;
+        int points_per_sector = params.topology_points_per_sector;
+        bool beautify = params.beautify;
+        if (num_sides < 3 || points_per_sector < 1) return false;
 
-	// 如果不需要美化，直接返回
-	if (!beautify) return;
-
-    // 定义一个基本单元（子结构），位于圆内部
-    std::vector<glm::vec3> base_unit;
-    for (int j = 0; j < points_per_sector; ++j) {
-        // 将子结构点放在内部，例如在 0.5 * outer_radius 到 outer_radius 之间
-        // 这里可以调整 `inner_radius` 来控制子结构的大小
-        float inner_radius = outer_radius * (0.5f + 0.5f * (j + 1) / (points_per_sector + 1));
-        float angle_in_sector = (j + 1) * (2.0f * glm::pi<float>() / (num_sides * 2)); // 分布在扇区的一半内
-        float x = inner_radius * cos(angle_in_sector);
-        float y = inner_radius * sin(angle_in_sector);
-        base_unit.emplace_back(x, y, 0.0f);
-    }
+        float outer_radius = 1.0f;
+        AngleTable ring = ShapeGenerators::makeRingTable(num_sides);
 
-    // 复制并旋转子结构，放置在每个扇区内
-    float angle_step = 2.0f * glm::pi<float>() / num_sides;
-    for (int i = 0; i < num_sides; ++i) {
-        float angle = i * angle_step;
-        for (const auto& point : base_unit) {
-            // 旋转点
-            float x = point.x * cos(angle) - point.y * sin(angle);
-            float y = point.x * sin(angle) + point.y * cos(angle);
-            m_vertices.emplace_back(x, y, 0.0f);
+        // 本扇区拥有外圈第 0 个点和子结构；中心点和外圈第 1 个点只用来连边
+        mesh.sectorVertices.push_back(glm::vec3(outer_radius, 0.0f, 0.0f));
+        if (beautify) {
+            std::vector<glm::vec3> base_unit = ShapeGenerators::makeTopologyUnit(num_sides, points_per_sector, outer_radius);
+            mesh.sectorVertices.insert(mesh.sectorVertices.end(), base_unit.begin(), base_unit.end());
         }
+        mesh.ownedVertexCount = mesh.sectorVertices.size();
+        unsigned int center = static_cast<unsigned int>(mesh.sectorVertices.size());
+        mesh.sectorVertices.push_back(glm::vec3(0.0f, 0.0f, 0.0f));
+        mesh.sectorVertices.push_back(glm::vec3(outer_radius * ring.cosines[1], outer_radius * ring.sines[1], 0.0f));
+        unsigned int next_outer = center + 1;
+
+        // 和 generate2DTopology 中属于扇区 i 的边一一对应：中心到外圈、外圈到下一个外圈、子结构链、子结构到外圈、中心到子结构
+        mesh.sectorIndices = { center, 0, 0, next_outer };
+        if (beautify) {
+            for (int j = 0; j < points_per_sector - 1; ++j) {
+                mesh.sectorIndices.push_back(1 + j);
+                mesh.sectorIndices.push_back(2 + j);
+            }
+            mesh.sectorIndices.push_back(points_per_sector);
+            mesh.sectorIndices.push_back(0);
+            mesh.sectorIndices.push_back(center);
+            mesh.sectorIndices.push_back(1);
+        }
+        mesh.fixedVertices.push_back(glm::vec3(0.0f, 0.0f, 0.0f));
+        mesh.rotationCount = num_sides;
+        return true;
     }
 
-    // 连接每个子结构内部的点
-    for (int i = 0; i < num_sides; ++i) {
-        int start = base_vertex_offset + i * vertices_per_sector;
-        for (int j = 0; j < vertices_per_sector - 1; ++j) {
-            m_indices.push_back(start + j);
-            m_indices.push_back(start + j + 1);
+    if (params.shape == ShapeType::SPHERE) {
+        int sectors = params.sphere_sectors;
+        int points_per_sector = params.sphere_points_per_sector;
+        int layers = params.sphere_layers;
+        bool beautify = params.beautify;
+        if (sectors < 3 || layers < 1) return false;
+        if (beautify && points_per_sector < 1) return false;
+
+        float radius = 1.0f;
+        std::vector<float> layer_z;
+        std::vector<float> layer_radius;
+        ShapeGenerators::makeSphereLayers(layers, radius, layer_z, layer_radius);
+
+        // 扇区 0 的经线和螺旋线，布局和 generateSphere 中每个扇区的数据块相同
+        int meridian_points = 2 * layers + 1;
+        for (int j = 0; j < meridian_points; ++j) {
+            mesh.sectorVertices.push_back(glm::vec3(layer_radius[j], 0.0f, layer_z[j]));
+        }
+        for (int k = 0; k < 2 * layers; ++k) {
+            mesh.sectorIndices.push_back(k);
+            mesh.sectorIndices.push_back(k + 1);
+        }
+        if (beautify) {
+            std::vector<glm::vec3> spiral_unit = ShapeGenerators::makeSphereSpiralUnit(sectors, points_per_sector, radius);
+            mesh.sectorVertices.insert(mesh.sectorVertices.end(), spiral_unit.begin(), spiral_unit.end());
+            unsigned int spiral1_start = meridian_points;
+            unsigned int spiral2_start = spiral1_start + points_per_sector + 1;
+            for (unsigned int start : { spiral1_start, spiral2_start }) {
+                for (int k = 0; k < points_per_sector; ++k) {
+                    mesh.sectorIndices.push_back(start + k);
+                    mesh.sectorIndices.push_back(start + k + 1);
+                }
+            }
         }
-        // 连接子结构最后一个点到外圈顶点
-        m_indices.push_back(start + vertices_per_sector - 1);
-        m_indices.push_back(1 + i); // 对应外圈第 i 个点
+        mesh.ownedVertexCount = mesh.sectorVertices.size();
+        mesh.fixedVertices.push_back(glm::vec3(0.0f, 0.0f, 0.0f));
+        mesh.rotationCount = sectors;
+        return true;
     }
 
-    // 连接中心点到子结构的某些点
-    for (int i = 0; i < num_sides; ++i) {
-        int sector_start_index = base_vertex_offset + i * vertices_per_sector;
-        // 连接到子结构的第一个点
-        m_indices.push_back(0); // 中心点
-        m_indices.push_back(sector_start_index); // 子结构内部点
-    }
+    return false;
 }
 
-void TopologyGraph::generateSphere(int sectors, int points_per_sector, int layers,bool beautify) {
-    if (sectors < 3) return;
-
-    // 添加球心点
-    m_vertices.emplace_back(0.0f, 0.0f, 0.0f);
-    int centerIndex = 0;
-    float radius = 1.0f;
-    float layerHeightStep = radius / layers;
-
-    // 在XOY平面上生成正多边形的顶点作为球面点
-    std::vector<int> surfaceIndices;
-    float angleStep = 2.0f * glm::pi<float>() / sectors;
-
-    for (int i = 0; i < sectors; ++i) {
-        float angle = i * angleStep;
-        for (int j = -layers; j <= layers; ++j) {
-            float height = radius * j / layers;
-            float z = height;
-            float newRadius = sqrt(radius * radius - z * z);
-            float x = newRadius * cos(angle);
-            float y = newRadius * sin(angle);
-            m_vertices.push_back(glm::vec3(x, y, z));
-        }
+void TopologyGraph::weldVertices() {
+    size_t vertex_count = m_vertices.size();
+    if (vertex_count == 0) return;
 
-        // 当前扇区第一个点的索引
-        int idx = m_vertices.size() - (2 * layers + 1); 
-
-        // 连接相邻的表面点形成球面环
-        for (int k = 0; k < 2 * layers; ++k) {
-            int current = idx + k;
-            int next = idx + k + 1;
-            m_indices.push_back(current);
-            m_indices.push_back(next);
+    float max_abs = 0.0f;
+    for (const glm::vec3& v : m_vertices) {
+        max_abs = std::max(max_abs, std::max(std::fabs(v.x), std::max(std::fabs(v.y), std::fabs(v.z))));
+    }
+    const float tolerance = (max_abs > 0.0f ? max_abs : 1.0f) * kWeldTolerance;
+    const float inv_cell = 1.0f / (tolerance * kWeldCellScale);
+    // 向下取整到格子坐标，不调用 std::floor，避免在没有 SSE4.1 的编译选项下变成函数调用
+    auto cellOf = [inv_cell](float value) {
+        float scaled = value * inv_cell;
+        int64_t cell = static_cast<int64_t>(scaled);
+        return static_cast<float>(cell) > scaled ? cell - 1 : cell;
+    };
+
+    // 空间哈希：每个槽保存格子哈希的高 32 位和代表顶点的新编号，线性探测只访问连续内存，
+    // 高 32 位不同的槽不用读取顶点坐标；不同格子哈希冲突也没关系，最终以坐标距离为准
+    struct Slot {
+        uint32_t tag;
+        uint32_t vertex;
+    };
+    std::vector<Slot> table(hashTableSize(vertex_count), Slot{ 0, kEmptySlot });
+    const size_t mask = table.size() - 1;
+    std::vector<unsigned int> remap(vertex_count);
+
+    // 在一个格子的探测链上查找容差内的代表顶点，没找到时 empty_slot 为链尾的空槽
+    auto findInCell = [&](uint64_t hash, const glm::vec3& p, size_t& empty_slot) {
+        uint32_t tag = static_cast<uint32_t>(hash >> 32);
+        size_t slot = hash & mask;
+        for (; table[slot].vertex != kEmptySlot; slot = (slot + 1) & mask) {
+            if (table[slot].tag != tag) continue;
+            glm::vec3 d = glm::abs(m_vertices[table[slot].vertex] - p);
+            if (d.x <= tolerance && d.y <= tolerance && d.z <= tolerance) return table[slot].vertex;
+        }
+        empty_slot = slot;
+        return kEmptySlot;
+    };
+
+    // 代表顶点按第一次出现的顺序原地压缩到数组前部，新编号不会超过旧编号，不会覆盖还没处理的顶点
+    size_t welded_count = 0;
+    for (size_t i = 0; i < vertex_count; ++i) {
+        if ((i & 0xFFFF) == 0 && isCancelled()) return;
+
+        // 哈希表的访问是随机的，提前预取后面顶点所在格子的槽，隐藏内存延迟
+        if (i + kWeldPrefetchDistance < vertex_count) {
+            const glm::vec3& ahead = m_vertices[i + kWeldPrefetchDistance];
+            prefetchRead(&table[cellHash(cellOf(ahead.x), cellOf(ahead.y), cellOf(ahead.z)) & mask]);
         }
 
-		// 如果美化选项开启，添加扇面内的三维螺旋线
-        if (beautify) {
-			// 添加一半扇面内的三维螺旋线
-            std::vector<int> spiralPoints1;
-            for (int spiral = 0; spiral <= points_per_sector; ++spiral) {
-                float spiralProgress = static_cast<float>(spiral) / points_per_sector;  // 0到1
-                float spiralAngle = angle + spiralProgress * angleStep * 0.5f;  // 螺旋角度变化
-                float spiralRadius = radius * spiralProgress;  // 径向距离
-                float spiralZ = radius * sin(spiralProgress * glm::pi<float>()) * 0.5f;  // z方向螺旋变化
-
-                // 计算螺旋线上的点
-                float spiralX = spiralRadius * cos(spiralAngle);
-                float spiralY = spiralRadius * sin(spiralAngle);
-
-                // 添加螺旋线点
-                m_vertices.push_back(glm::vec3(spiralX, spiralY, spiralZ));
-                spiralPoints1.push_back(static_cast<int>(m_vertices.size() - 1));
-            }
-
-            // 连接第一条螺旋线上的相邻点
-            for (int k = 0; k < spiralPoints1.size() - 1; ++k) {
-                m_indices.push_back(spiralPoints1[k]);
-                m_indices.push_back(spiralPoints1[k + 1]);
-            }
+        const glm::vec3 p = m_vertices[i];
+        int64_t home[3] = { cellOf(p.x), cellOf(p.y), cellOf(p.z) };
+        uint64_t home_hash = cellHash(home[0], home[1], home[2]);
 
-            // 添加另一半扇面内的三维螺旋线
-            std::vector<int> spiralPoints2;
-            for (int spiral = 0; spiral <= points_per_sector; ++spiral) {
-                float spiralProgress = static_cast<float>(spiral) / points_per_sector;  // 0到1
-                float spiralAngle = angle + angleStep * 0.5f + spiralProgress * angleStep * 0.5f;  // 螺旋角度变化（从扇面中间开始）
-                float spiralRadius = radius * spiralProgress;  // 径向距离
-                float spiralZ = -radius * sin(spiralProgress * glm::pi<float>()) * 0.5f;  // z方向螺旋变化（相反方向）
-
-                // 计算螺旋线上的点
-                float spiralX = spiralRadius * cos(spiralAngle);
-                float spiralY = spiralRadius * sin(spiralAngle);
-
-                // 添加螺旋线点
-                m_vertices.push_back(glm::vec3(spiralX, spiralY, spiralZ));
-                spiralPoints2.push_back(static_cast<int>(m_vertices.size() - 1));
-            }
+        // 先查自己所在的格子，大多数顶点只需要这一次查找，新顶点直接插入到这条探测链的末尾
+        size_t insert_slot = 0;
+        uint32_t found = findInCell(home_hash, p, insert_slot);
 
-            // 连接第二条螺旋线上的相邻点
-            for (int k = 0; k < spiralPoints2.size() - 1; ++k) {
-                m_indices.push_back(spiralPoints2[k]);
-                m_indices.push_back(spiralPoints2[k + 1]);
+        // 离格子边界不到一个容差时，再查容差范围覆盖到的相邻格子，每个方向最多两个
+        if (found == kEmptySlot) {
+            int64_t low[3], high[3];
+            for (int k = 0; k < 3; ++k) {
+                low[k] = cellOf(p[k] - tolerance);
+                high[k] = cellOf(p[k] + tolerance);
             }
+            size_t unused = 0;
+            for (int64_t x = low[0]; x <= high[0] && found == kEmptySlot; ++x)
+                for (int64_t y = low[1]; y <= high[1] && found == kEmptySlot; ++y)
+                    for (int64_t z = low[2]; z <= high[2] && found == kEmptySlot; ++z) {
+                        if (x == home[0] && y == home[1] && z == home[2]) continue;
+                        found = findInCell(cellHash(x, y, z), p, unused);
+                    }
         }
-    }
-}
 
-void TopologyGraph::generateTorus(int main_segments, int tube_segments, float main_r, float tube_r,bool beautify) {
-	// 绘制基础圆环管
-    for (int i = 0; i < main_segments; ++i) {
-        for (int j = 0; j < tube_segments; ++j) {
-            float u = (float)i / main_segments * 2.0f * glm::pi<float>();
-            float v = (float)j / tube_segments * 2.0f * glm::pi<float>();
-            float x = (main_r + tube_r * std::cos(v)) * std::cos(u);
-            float y = (main_r + tube_r * std::cos(v)) * std::sin(u);
-            float z = tube_r * std::sin(v);
-            m_vertices.emplace_back(x, y, z);
-            unsigned int current = i * tube_segments + j;
-            unsigned int next_j = i * tube_segments + (j + 1) % tube_segments;
-            unsigned int next_i = ((i + 1) % main_segments) * tube_segments + j;
-            m_indices.push_back(current); m_indices.push_back(next_j);
-            m_indices.push_back(current); m_indices.push_back(next_i);
+        if (found != kEmptySlot) {
+            remap[i] = found;
+            continue;
         }
-    }
 
-	// 如果不需要美化，直接返回
-	if (!beautify) return;
-
-    // 在管道内部添加螺旋线点和边
-    for (int i = 0; i < main_segments; i += 2) {  
-        // 每隔一个主段添加内部结构
-        for (int k = 0; k < 3; ++k) {  
-            // 每个主段添加3条内部螺旋线
-            std::vector<int> inner_spiral_points;
-            float phase_offset = static_cast<float>(k) * 2.0f * glm::pi<float>() / 3.0f;  // 相位偏移
+        uint32_t index = static_cast<uint32_t>(welded_count++);
+        m_vertices[index] = p;
+        remap[i] = index;
+        table[insert_slot] = Slot{ static_cast<uint32_t>(home_hash >> 32), index };
+    }
+    m_vertices.resize(welded_count);
+    std::vector<Slot>().swap(table);
+
+    // 重新映射索引，去掉退化边和重复边（不区分方向），保留每条边第一次出现的位置和方向
+    size_t edge_count = m_indices.size() / 2;
+    std::vector<uint64_t> edges(hashTableSize(edge_count), kEmptyEdge);
+    const size_t edge_mask = edges.size() - 1;
+    auto edgeKey = [&](size_t e) {
+        unsigned int a = remap[m_indices[e * 2]];
+        unsigned int b = remap[m_indices[e * 2 + 1]];
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    };
+
+    size_t kept = 0;
+    for (size_t e = 0; e < edge_count; ++e) {
+        if ((e & 0xFFFF) == 0 && isCancelled()) return;
+        // 前面的边已经写回的位置不会超过 e，预取时读到的索引还是原始数据
+        if (e + kWeldPrefetchDistance < edge_count) {
+            prefetchRead(&edges[mixHash(edgeKey(e + kWeldPrefetchDistance)) & edge_mask]);
+        }
 
-            for (int spiral = 0; spiral <= tube_segments; ++spiral) {
-                float u = (float)i / main_segments * 2.0f * glm::pi<float>();
-                float v = (float)spiral / tube_segments * 2.0f * glm::pi<float>() * 2.0f + phase_offset;  // 螺旋角度
-                float inner_tube_r = tube_r * 0.5f; 
+        unsigned int a = remap[m_indices[e * 2]];
+        unsigned int b = remap[m_indices[e * 2 + 1]];
+        if (a == b) continue;
 
-                float x = (main_r + inner_tube_r * std::cos(v)) * std::cos(u);
-                float y = (main_r + inner_tube_r * std::cos(v)) * std::sin(u);
-                float z = inner_tube_r * std::sin(v);
+        uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        size_t slot = mixHash(key) & edge_mask;
+        while (edges[slot] != kEmptyEdge && edges[slot] != key) slot = (slot + 1) & edge_mask;
+        if (edges[slot] == key) continue;
+        edges[slot] = key;
 
-                m_vertices.emplace_back(x, y, z);
-                inner_spiral_points.push_back(static_cast<int>(m_vertices.size() - 1));
-            }
+        m_indices[kept * 2] = a;
+        m_indices[kept * 2 + 1] = b;
+        ++kept;
+    }
+    m_indices.resize(kept * 2);
+}
 
-            // 连接内部螺旋线上的相邻点
-            for (int p = 0; p < inner_spiral_points.size() - 1; ++p) {
-                m_indices.push_back(inner_spiral_points[p]);
-                m_indices.push_back(inner_spiral_points[p + 1]);
-            }
+void TopologyGraph::encodeOutput(const Parameters& params, GraphChange change) {
+    // 命中缓存时数据在映射的文件中
+    ArrayView<glm::vec3> vertices = getVertices();
+    ArrayView<unsigned int> indices = getIndices();
+    size_t vertex_count = vertices.size();
+    const size_t chunk = kMinParallelVertices;
 
-            // 连接内部螺旋线到外部管壁
-            for (int p = 0; p < inner_spiral_points.size(); ++p) {
-                if (p < tube_segments) {
-                    unsigned int outer_idx = i * tube_segments + p;
-                    m_indices.push_back(inner_spiral_points[p]);
-                    m_indices.push_back(outer_idx);
+    if (params.position_format == PositionFormat::FLOAT32) {
+        m_packedPositions.clear();
+        m_positionScale = 1.0f;
+    }
+    else {
+        resizeStorage(m_packedPositions, vertex_count * 4);
+        m_positionScale = 1.0f;
+        float inv_scale = 1.0f;
+        if (params.position_format == PositionFormat::SNORM16) {
+            // 先求出所有坐标分量绝对值的最大值，作为量化的缩放
+            float max_abs = 0.0f;
+            std::mutex max_mutex;
+            forEachRange(vertex_count, chunk, [&](size_t begin, size_t end) {
+                float local_max = 0.0f;
+                for (size_t i = begin; i < end; ++i) {
+                    const glm::vec3& v = vertices[i];
+                    local_max = std::max(local_max, std::max(std::fabs(v.x), std::max(std::fabs(v.y), std::fabs(v.z))));
                 }
-            }
+                std::lock_guard<std::mutex> lock(max_mutex);
+                max_abs = std::max(max_abs, local_max);
+            });
+            if (max_abs > 0.0f) m_positionScale = max_abs;
+            inv_scale = 1.0f / m_positionScale;
         }
-    }
 
-    // 添加管子截面内的径向线
-    for (int i = 0; i < main_segments; i += 3) {  
-        // 每隔几个主段添加径向结构
-        for (int j = 0; j < tube_segments; j += 2) {  
-            // 每隔几个管段添加径向线
-            float u = (float)i / main_segments * 2.0f * glm::pi<float>();
-
-            // 添加管子内部的径向点
-            for (int radial = 1; radial <= 3; ++radial) {  
-                float radial_ratio = static_cast<float>(radial) / 4.0f;  
-                float inner_tube_r = tube_r * radial_ratio;
-                float v = (float)j / tube_segments * 2.0f * glm::pi<float>();
-
-                float x = (main_r + inner_tube_r * std::cos(v)) * std::cos(u);
-                float y = (main_r + inner_tube_r * std::cos(v)) * std::sin(u);
-                float z = inner_tube_r * std::sin(v);
-
-                m_vertices.emplace_back(x, y, z);
-                int inner_radial_idx = static_cast<int>(m_vertices.size() - 1);
-
-                // 连接到管壁上的对应点
-                unsigned int outer_idx = i * tube_segments + j;
-                m_indices.push_back(inner_radial_idx);
-                m_indices.push_back(outer_idx);
-
-                // 连接内部径向点之间的层
-                if (radial > 1) {
-                    int prev_inner_idx = static_cast<int>(m_vertices.size() - 2); 
-                    m_indices.push_back(inner_radial_idx);
-                    m_indices.push_back(prev_inner_idx);
+        bool half = params.position_format == PositionFormat::HALF_FLOAT;
+        forEachRange(vertex_count, chunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const glm::vec3& v = vertices[i];
+                uint16_t* out = m_packedPositions.data() + i * 4;
+                for (int k = 0; k < 3; ++k) {
+                    out[k] = half ? floatToHalf(v[k]) : floatToSnorm16(v[k], inv_scale);
                 }
+                out[3] = 0;
             }
-        }
+        });
     }
 
-    // 添加装饰性螺旋线
-    for (int spiral_num = 0; spiral_num < 4; ++spiral_num) { 
-        // 4条装饰螺旋线
-        std::vector<int> decorative_spiral;
-        float main_spiral_offset = static_cast<float>(spiral_num) * glm::pi<float>() / 2.0f;
-
-        for (int k = 0; k <= main_segments * 2; ++k) {  
-            // 跨越2圈的螺旋
-            float main_progress = static_cast<float>(k) / (main_segments * 2);
-
-            float u = main_progress * 2.0f * glm::pi<float>() * 2.0f + main_spiral_offset;  
-            float v = main_progress * 2.0f * glm::pi<float>() * 3.0f + main_spiral_offset; 
-            float inner_tube_r = tube_r * 0.7f;  
-            float x = (main_r + inner_tube_r * std::cos(v)) * std::cos(u);
-            float y = (main_r + inner_tube_r * std::cos(v)) * std::sin(u);
-            float z = inner_tube_r * std::sin(v);
-
-            m_vertices.emplace_back(x, y, z);
-            decorative_spiral.push_back(static_cast<int>(m_vertices.size() - 1));
+    // 只变坐标时索引不变，16 位索引也不用重算
+    if (change != GraphChange::TOPOLOGY) return;
+    m_useShortIndices = params.short_indices && vertex_count <= kMaxShortIndexVertices;
+    if (!m_useShortIndices) {
+        m_shortIndices.clear();
+        return;
+    }
+    resizeStorage(m_shortIndices, indices.size());
+    forEachRange(indices.size(), chunk * 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_shortIndices[i] = static_cast<uint16_t>(indices[i]);
         }
+    });
+}
 
-        // 连接装饰螺旋线上的相邻点
-        for (int p = 0; p < decorative_spiral.size() - 1; ++p) {
-            m_indices.push_back(decorative_spiral[p]);
-            m_indices.push_back(decorative_spiral[p + 1]);
+void TopologyGraph::forEachRange(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body) {
+    if (m_cancelFlag) {
+        // 按块执行，取消后剩下的块都跳过；各块互不重叠，切块方式不影响结果
+        auto cancellable = [&](size_t chunk_begin, size_t chunk_end) {
+            if (isCancelled()) return;
+            body(chunk_begin, chunk_end);
+        };
+        if (!m_threadPool || count <= minChunk) {
+            for (size_t chunk_begin = 0; chunk_begin < count; chunk_begin += minChunk) {
+                cancellable(chunk_begin, std::min(count, chunk_begin + minChunk));
+            }
+            return;
         }
+        m_threadPool->parallelFor(0, count, minChunk, cancellable);
+        return;
+    }
+
+    // 没有线程池或工作量太小时直接在当前线程执行，避免调度开销
+    if (!m_threadPool || count <= minChunk) {
+        body(0, count);
+        return;
     }
+    m_threadPool->parallelFor(0, count, minChunk, body);
 }
@@ -1,16 +1,35 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <glm/glm.hpp>
 
+class ThreadPool;
+class MeshCache;
+class CachedMesh;
+
 // 鍥惧舰绫诲瀷锛屽垎鍒#pragma once
 #include <vector>
 #include <string>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <glm/glm.hpp>
 
-// 图形类型，分别为 2D 拓扑图、球体和圆环管
+class ThreadPool;
+class MeshCache;
+class CachedMesh;
+
+// 图形类型，分别为 2D 拓扑图、球体、圆环管和立方体晶格
 enum class ShapeType { TOPOLOGY_2D, SPHERE, TORUS, CUBE };
 
+// 顶点坐标的输出格式：32 位浮点、按包围盒缩放的 16 位有符号归一化整数、16 位半精度浮点
+enum class PositionFormat { FLOAT32, SNORM16, HALF_FLOAT };
+
 // 参数结构体
 struct Parameters {
     ShapeType shape = ShapeType::TOPOLOGY_2D;
@@ -38,30 +57,169 @@ struct Parameters {
     int torus_tube_segments = 20;
     float torus_main_radius = 1.0f;
     float torus_tube_radius = 0.3f;
+
+    // 立方体晶格参数：每条棱的分段数和棱长，美化时在每个小立方体中心加一个点连到 8 个角（体心立方）
+    int cube_segments = 4;
+    float cube_size = 1.5f;
+
+    // 输出编码：除了 32 位浮点坐标之外额外输出的紧凑坐标格式，
+    // 以及顶点数不超过 65536 时是否额外输出 16 位索引
+    PositionFormat position_format = PositionFormat::FLOAT32;
+    bool short_indices = false;
+
+    // 生成后合并重合的顶点，并去掉重复边和两端相同的退化边，得到真正的图
+    // 例如球体的两极、美化螺旋线的中心点在每个扇区都会重复生成
+    bool weld_vertices = false;
+};
+
+
+// 连续数组的只读视图，数据可能在 std::vector 中，也可能在内存映射的缓存文件中
+template <typename T>
+class ArrayView {
+public:
+    ArrayView() = default;
+    ArrayView(const T* data, size_t size) : m_data(data), m_size(size) {}
+    ArrayView(const std::vector<T>& values) : m_data(values.data()), m_size(values.size()) {}
+
+    const T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const T& operator[](size_t i) const { return m_data[i]; }
+    const T& front() const { return m_data[0]; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+
+private:
+    const T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// 网格规模：顶点数和索引数（每两个索引构成一条边）
+struct MeshSize {
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+};
+
+// 旋转对称图形的紧凑描述：只保存一个扇区，扇区 i 绕 z 轴旋转 i * 2pi / rotationCount 得到
+// 展开后的顶点数和边数与 generate 生成的完全相同
+struct SymmetricMesh {
+    // 扇区 0 的顶点，前 ownedVertexCount 个属于本扇区，
+    // 其余是连边时引用的中心点或相邻扇区的点，绘制节点时不画，避免重复
+    std::vector<glm::vec3> sectorVertices;
+    size_t ownedVertexCount = 0;
+    // 扇区 0 内的边，索引指向 sectorVertices
+    std::vector<unsigned int> sectorIndices;
+    // 不随扇区重复、只出现一次的点（例如中心点）
+    std::vector<glm::vec3> fixedVertices;
+    int rotationCount = 0;
 };
 
+// 两次生成之间图形数据的变化程度
+// NONE：没有变化；POSITIONS：只有顶点坐标变化，顶点数和索引完全不变；TOPOLOGY：需要整体重建
+enum class GraphChange { NONE, POSITIONS, TOPOLOGY };
 
 // 拓扑图类
 class TopologyGraph {
 public:
-	// 生成图形
-    void generate(const Parameters& params);
+	// 生成图形，返回和上一次生成相比的变化程度
+    // 只有几何参数（圆环的两个半径、立方体的棱长）变化时只重算顶点坐标，索引保持不变
+    GraphChange generate(const Parameters& params);
 
-	// 获取顶点和索引数据
-    const std::vector<glm::vec3>& getVertices() const { return m_vertices; }
-    const std::vector<unsigned int>& getIndices() const { return m_indices; }
+    // 比较两组参数：拓扑参数（形状、美化、各种段数和点数）变化需要整体重建，
+    // 几何参数变化只影响顶点坐标，与当前形状无关的参数和自动旋转不影响图形
+    static GraphChange classifyChange(const Parameters& before, const Parameters& after);
+
+    // 不生成任何数据，直接按公式算出给定参数下的顶点数和索引数
+    // 可用于提前分配输出文件和 GPU 缓冲区；开启顶点焊接时这是焊接前的数量，即实际数量的上限
+    static MeshSize computeSize(const Parameters& params);
+
+    // 抽稀的预览参数：当前形状的各个分辨率参数（段数、扇区数、层数、点数）同时变为 1/k（向上取整，不低于各自的下限），
+    // 取使顶点数不超过 maxVertices 的最小 k；k 整除原值时预览正好是完整图形每隔 k 段取一段
+    // 其他参数不变，整体形状和完整图形一致；本来就不超过上限时原样返回
+    static Parameters makePreviewParameters(const Parameters& params, size_t maxVertices);
+
+    // 2D 拓扑图和球体由同一个扇区旋转复制而成，只生成一个扇区的数据供实例化绘制
+    // 其他形状或参数无效时返回 false
+    static bool describeSymmetry(const Parameters& params, SymmetricMesh& mesh);
+
+    // 设置线程池后，球体、圆环和立方体按扇区 / 主段 / 层切分到多个线程并行生成，结果和单线程完全一致
+    // 传入 nullptr 恢复单线程生成
+    void setThreadPool(ThreadPool* pool) { m_threadPool = pool; }
+
+    // 设置取消标志，生成过程中每处理完一块数据检查一次，标志为 true 时尽快返回
+    // 被取消后数据不完整，下一次生成一定会整体重建；调用方根据自己的标志判断这次结果是否可用
+    void setCancelFlag(const std::atomic<bool>* flag) { m_cancelFlag = flag; }
+
+    // 设置磁盘缓存后，生成前先按参数查找缓存文件，命中时直接映射文件，不再生成和焊接；
+    // 未命中且生成耗时超过缓存的阈值时复制一份结果交给缓存的后台线程写入。传入 nullptr 关闭缓存，缓存不归本类所有
+    void setMeshCache(MeshCache* cache) { m_meshCache = cache; }
+    // 当前数据是否来自缓存文件的映射
+    bool isFromCache() const { return m_cachedMesh != nullptr; }
+
+    // 当前数据对应的参数，只有 hasGenerated() 为 true 时有意义
+    bool hasGenerated() const { return m_hasGenerated; }
+    const Parameters& getParameters() const { return m_generatedParams; }
+
+	// 获取顶点和索引数据，命中缓存时指向映射的文件，下一次 generate 之前一直有效
+    ArrayView<glm::vec3> getVertices() const;
+    ArrayView<unsigned int> getIndices() const;
+
+    // 紧凑编码的数据，按参数中的输出编码在生成时一并计算
+    // 紧凑坐标每个顶点 4 个 16 位分量，第 4 个分量为 0，凑成 8 字节便于 GPU 读取
+    // SNORM16 格式解码后还要乘以 getPositionScale()，其他格式缩放为 1
+    PositionFormat getPositionFormat() const { return m_generatedParams.position_format; }
+    const std::vector<uint16_t>& getPackedPositions() const { return m_packedPositions; }
+    float getPositionScale() const { return m_positionScale; }
+    // 只有参数要求且顶点数不超过 65536 时才有 16 位索引
+    bool hasShortIndices() const { return m_useShortIndices; }
+    const std::vector<uint16_t>& getShortIndices() const { return m_shortIndices; }
+    // 每个顶点坐标占用的字节数
+    static size_t getPositionStride(PositionFormat format) { return format == PositionFormat::FLOAT32 ? sizeof(glm::vec3) : 4 * sizeof(uint16_t); }
 
 	// 方便获取顶点数和边数
-    size_t getVertexCount() const { return m_vertices.size(); }
-    size_t getIndexCount() const { return m_indices.size(); }
+    size_t getVertexCount() const { return getVertices().size(); }
+    size_t getIndexCount() const { return getIndices().size(); }
 
 private:
 	// 顶点和索引数据
     std::vector<glm::vec3> m_vertices;
     std::vector<unsigned int> m_indices;
 
-    // 图像生成函数
-    void generate2DTopology(int num_sides,int points_per_sector,bool beautify);
-	void generateSphere(int sectors, int points_per_sector, int layers, bool beautify);
-    void generateTorus(int main_segments, int tube_segments, float main_r, float tube_r, bool beautify);
+    // 紧凑编码的坐标和索引
+    std::vector<uint16_t> m_packedPositions;
+    float m_positionScale = 1.0f;
+    std::vector<uint16_t> m_shortIndices;
+    bool m_useShortIndices = false;
+
+    // 并行生成使用的线程池，不归本类所有
+    ThreadPool* m_threadPool = nullptr;
+    // 取消标志，不归本类所有
+    const std::atomic<bool>* m_cancelFlag = nullptr;
+
+    // 磁盘缓存，不归本类所有；命中时数据在 m_cachedMesh 中，m_vertices 和 m_indices 为空
+    MeshCache* m_meshCache = nullptr;
+    std::shared_ptr<const CachedMesh> m_cachedMesh;
+
+    // 上一次生成使用的参数，用于判断下一次生成可以只更新顶点坐标
+    Parameters m_generatedParams;
+    bool m_hasGenerated = false;
+
+    // 按参数调用对应形状的生成器（见 ShapeGenerators.h），写入已经分配好大小的顶点和索引数组
+    // positionsOnly 为 true 时只重写顶点坐标，要求数组已经按相同的拓扑参数生成过
+    void fillShape(const Parameters& params, bool positionsOnly);
+
+    // 把映射的缓存数据复制到 m_vertices 和 m_indices，之后可以原地修改
+    void detachCachedMesh();
+
+    // 合并坐标在容差内重合的顶点，重新映射索引，去掉退化边和重复边
+    // 顶点和边都保留第一次出现的相对顺序，用空间哈希和边哈希实现，时间复杂度为线性
+    void weldVertices();
+
+    // 按参数中的输出编码计算紧凑坐标，拓扑变化时再计算 16 位索引
+    void encodeOutput(const Parameters& params, GraphChange change);
+
+    // 把 [0, count) 交给线程池分块执行，没有线程池时直接在当前线程执行
+    // 设置了取消标志时按块检查，已取消的块直接跳过
+    void forEachRange(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body);
+    bool isCancelled() const { return m_cancelFlag && m_cancelFlag->load(std::memory_order_relaxed); }
 };
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "TrigKernel.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOPOLOGY_HAS_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+// 绾﹀噺甯告暟鍜屽#include "TrigKernel.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOPOLOGY_HAS_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+// 约减常数和多项式系数定义在头文件中，和编译期版本共用
+using namespace TrigKernel;
+
+void sincosScalar(const float* angles, float* sines, float* cosines, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // 和 SIMD 版本一样直接取符号位，-0 也能得到相同结果
+        float x = angles[i];
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        uint32_t signBit = bits >> 31;
+        x = std::fabs(x);
+
+        // 约减到 [-pi/4, pi/4]，j 为八分区编号（取偶数）
+        int32_t j = static_cast<int32_t>(x * kFourOverPi);
+        j = (j + 1) & ~1;
+        float y = static_cast<float>(j);
+        x = ((x - y * kDP1) - y * kDP2) - y * kDP3;
+
+        float z = x * x;
+        float polyCos = ((kCosC0 * z + kCosC1) * z + kCosC2) * z * z - 0.5f * z + 1.0f;
+        float polySin = ((kSinC0 * z + kSinC1) * z + kSinC2) * z * x + x;
+
+        // j 的第 2 位决定 sin / cos 是否互换，第 4 位决定符号
+        bool swap = (j & 2) != 0;
+        float s = swap ? polyCos : polySin;
+        float c = swap ? polySin : polyCos;
+        uint32_t sinSign = signBit ^ ((j & 4) ? 1u : 0u);
+        uint32_t cosSign = ((j + 2) & 4) ? 1u : 0u;
+        sines[i] = sinSign ? -s : s;
+        cosines[i] = cosSign ? -c : c;
+    }
+}
+
+#ifdef TOPOLOGY_HAS_SSE2
+
+void sincosSSE2(const float* angles, float* sines, float* cosines, size_t count) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i notOne = _mm_set1_epi32(~1);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(angles + i);
+        __m128 inputSign = _mm_and_ps(x, signMask);
+        x = _mm_andnot_ps(signMask, x);
+
+        __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(kFourOverPi)));
+        j = _mm_and_si128(_mm_add_epi32(j, one), notOne);
+        __m128 y = _mm_cvtepi32_ps(j);
+        x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(kDP1)));
+        x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(kDP2)));
+        x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(kDP3)));
+
+        __m128 z = _mm_mul_ps(x, x);
+        __m128 polyCos = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kCosC0), z), _mm_set1_ps(kCosC1));
+        polyCos = _mm_add_ps(_mm_mul_ps(polyCos, z), _mm_set1_ps(kCosC2));
+        polyCos = _mm_mul_ps(_mm_mul_ps(polyCos, z), z);
+        polyCos = _mm_sub_ps(polyCos, _mm_mul_ps(_mm_set1_ps(0.5f), z));
+        polyCos = _mm_add_ps(polyCos, _mm_set1_ps(1.0f));
+
+        __m128 polySin = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kSinC0), z), _mm_set1_ps(kSinC1));
+        polySin = _mm_add_ps(_mm_mul_ps(polySin, z), _mm_set1_ps(kSinC2));
+        polySin = _mm_mul_ps(_mm_mul_ps(polySin, z), x);
+        polySin = _mm_add_ps(polySin, x);
+
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, two), two));
+        __m128 s = _mm_or_ps(_mm_and_ps(swap, polyCos), _mm_andnot_ps(swap, polySin));
+        __m128 c = _mm_or_ps(_mm_and_ps(swap, polySin), _mm_andnot_ps(swap, polyCos));
+
+        __m128 sinSign = _mm_xor_ps(inputSign, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, four), 29)));
+        __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, two), four), 29));
+        _mm_storeu_ps(sines + i, _mm_xor_ps(s, sinSign));
+        _mm_storeu_ps(cosines + i, _mm_xor_ps(c, cosSign));
+    }
+    sincosScalar(angles + i, sines + i, cosines + i, count - i);
+}
+
+// AVX2 版本单独指定目标指令集编译，运行时检测到 CPU 支持时才会调用
+#if defined(__GNUC__) || defined(__clang__)
+#define TOPOLOGY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TOPOLOGY_TARGET_AVX2
+#endif
+
+TOPOLOGY_TARGET_AVX2
+void sincosAVX2(const float* angles, float* sines, float* cosines, size_t count) {
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256i four = _mm256_set1_epi32(4);
+    const __m256i notOne = _mm256_set1_epi32(~1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(angles + i);
+        __m256 inputSign = _mm256_and_ps(x, signMask);
+        x = _mm256_andnot_ps(signMask, x);
+
+        __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(kFourOverPi)));
+        j = _mm256_and_si256(_mm256_add_epi32(j, one), notOne);
+        __m256 y = _mm256_cvtepi32_ps(j);
+        x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(kDP1)));
+        x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(kDP2)));
+        x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(kDP3)));
+
+        __m256 z = _mm256_mul_ps(x, x);
+        __m256 polyCos = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(kCosC0), z), _mm256_set1_ps(kCosC1));
+        polyCos = _mm256_add_ps(_mm256_mul_ps(polyCos, z), _mm256_set1_ps(kCosC2));
+        polyCos = _mm256_mul_ps(_mm256_mul_ps(polyCos, z), z);
+        polyCos = _mm256_sub_ps(polyCos, _mm256_mul_ps(_mm256_set1_ps(0.5f), z));
+        polyCos = _mm256_add_ps(polyCos, _mm256_set1_ps(1.0f));
+
+        __m256 polySin = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(kSinC0), z), _mm256_set1_ps(kSinC1));
+        polySin = _mm256_add_ps(_mm256_mul_ps(polySin, z), _mm256_set1_ps(kSinC2));
+        polySin = _mm256_mul_ps(_mm256_mul_ps(polySin, z), x);
+        polySin = _mm256_add_ps(polySin, x);
+
+        __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, two), two));
+        __m256 s = _mm256_blendv_ps(polySin, polyCos, swap);
+        __m256 c = _mm256_blendv_ps(polyCos, polySin, swap);
+
+        __m256 sinSign = _mm256_xor_ps(inputSign, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, four), 29)));
+        __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(j, two), four), 29));
+        _mm256_storeu_ps(sines + i, _mm256_xor_ps(s, sinSign));
+        _mm256_storeu_ps(cosines + i, _mm256_xor_ps(c, cosSign));
+    }
+    sincosSSE2(angles + i, sines + i, cosines + i, count - i);
+}
+
+bool cpuSupportsAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    // 需要 OSXSAVE 和 AVX，并且操作系统保存了 YMM 寄存器
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif
+
+using SincosFunc = void (*)(const float*, float*, float*, size_t);
+
+struct Dispatch {
+    SincosFunc func;
+    const char* name;
+
+    Dispatch() {
+#ifdef TOPOLOGY_HAS_SSE2
+        if (cpuSupportsAVX2()) {
+            func = sincosAVX2;
+            name = "AVX2";
+            return;
+        }
+        func = sincosSSE2;
+        name = "SSE2";
+#else
+        func = sincosScalar;
+        name = "scalar";
+#endif
+    }
+};
+
+const Dispatch& getDispatch() {
+    static const Dispatch dispatch;
+    return dispatch;
+}
+
+}
+
+namespace TrigKernel {
+
+void sincos(const float* angles, float* sines, float* cosines, size_t count) {
+    getDispatch().func(angles, sines, cosines, count);
+}
+
+const char* getInstructionSet() {
+    return getDispatch().name;
+}
+
+}
+
+void AngleTable::build(const std::vector<float>& angles) {
+    sines.resize(angles.size());
+    cosines.resize(angles.size());
+    TrigKernel::sincos(angles.data(), sines.data(), cosines.data(), angles.size());
+}
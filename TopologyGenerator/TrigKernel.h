@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 鎵归噺涓夎#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 批量三角函数计算，生成器在内层循环之前一次算好整圈点的 sin / cos
+// 运行时按 CPU 支持情况选择 AVX2、SSE2 或标量实现，三种实现使用完全相同的多项式和运算顺序，
+// 因此结果逐位一致，不会因为数据被切到 SIMD 主体还是尾部而不同
+namespace TrigKernel {
+    // sines[i] = sin(angles[i]), cosines[i] = cos(angles[i])
+    void sincos(const float* angles, float* sines, float* cosines, size_t count);
+
+    // 当前使用的指令集名称，方便在基准测试和界面中显示
+    const char* getInstructionSet();
+
+    // 多项式系数和三段式约减常数来自 Cephes 的 sinf / cosf，在 |x| < 8192 时误差约 1~2 ulp
+    // 所有实现都不使用 FMA，保证标量和 SIMD 的舍入完全一致
+    constexpr float kFourOverPi = 1.27323954473516f;
+    constexpr float kDP1 = 0.78515625f;
+    constexpr float kDP2 = 2.4187564849853515625e-4f;
+    constexpr float kDP3 = 3.77489497744594108e-8f;
+
+    constexpr float kSinC0 = -1.9515295891e-4f;
+    constexpr float kSinC1 = 8.3321608736e-3f;
+    constexpr float kSinC2 = -1.6666654611e-1f;
+    constexpr float kCosC0 = 2.443315711809948e-5f;
+    constexpr float kCosC1 = -1.388731625493765e-3f;
+    constexpr float kCosC2 = 4.166664568298827e-2f;
+
+    // 和 glm::pi<float>() 相同的值
+    constexpr float kPi = static_cast<float>(3.14159265358979323846264338327950288);
+
+    struct SinCos {
+        float sine;
+        float cosine;
+    };
+
+    // 编译期版本，约减、多项式和运算顺序都和运行时的实现相同，结果逐位一致
+    // 只用于非负角度：运行时版本按符号位处理 -0，编译期读不到符号位
+    constexpr SinCos sincosConstant(float x) {
+        int32_t j = static_cast<int32_t>(x * kFourOverPi);
+        j = (j + 1) & ~1;
+        float y = static_cast<float>(j);
+        x = ((x - y * kDP1) - y * kDP2) - y * kDP3;
+
+        float z = x * x;
+        float poly_cos = ((kCosC0 * z + kCosC1) * z + kCosC2) * z * z - 0.5f * z + 1.0f;
+        float poly_sin = ((kSinC0 * z + kSinC1) * z + kSinC2) * z * x + x;
+
+        bool swap = (j & 2) != 0;
+        float s = swap ? poly_cos : poly_sin;
+        float c = swap ? poly_sin : poly_cos;
+        return SinCos{ (j & 4) ? -s : s, ((j + 2) & 4) ? -c : c };
+    }
+}
+
+// 角度表：保存一组角度的 sin / cos，供生成器反复查表
+struct AngleTable {
+    std::vector<float> sines;
+    std::vector<float> cosines;
+
+    // angles 为任意角度数组
+    void build(const std::vector<float>& angles);
+
+    size_t size() const { return sines.size(); }
+};
+
+// 编译期算好的等分一圈的角度表，第 i 个角度为 i / Count * 2pi，和运行时按同样角度建的 AngleTable 逐位一致
+template <int Count>
+struct RingTable {
+    float sines[Count] = {};
+    float cosines[Count] = {};
+
+    constexpr RingTable() {
+        for (int i = 0; i < Count; ++i) {
+            TrigKernel::SinCos value = TrigKernel::sincosConstant(static_cast<float>(i) / Count * 2.0f * TrigKernel::kPi);
+            sines[i] = value.sine;
+            cosines[i] = value.cosine;
+        }
+    }
+};